@@ -1,11 +1,103 @@
 #include "Film.h"
 #include "FilmParser.h"
+#include "win/image.h"
 
 #include <algorithm>
+#include <fstream>
 #include <list>
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+#define PATH_SEPARATOR "\\"
+#else
+#define PATH_SEPARATOR "/"
+#endif
+
+/// <summary>
+/// Written next to a missing pre-scaled thumbnail when the original can't be scaled to it,
+/// because it can't be decoded or is already small enough, so that later runs don't decode it again.
+/// </summary>
+#define NO_THUMBNAIL_SUFFIX ".none"
+
 static std::list<Film*> g_loadedFilms;
 
+/// <summary>
+/// Films with pre-scaled thumbnails that still have to be generated, in the order they were loaded.
+/// </summary>
+static std::list<Film*> g_filmsMissingThumbnails;
+
+/// <summary>
+/// Folders, relative to the executable, that hold the pre-scaled thumbnails.
+/// Indexed by ThumbnailSize. The images keep the file name of the original thumbnail.
+/// </summary>
+static const char* g_thumbnailFolders[] = {
+	"assets" PATH_SEPARATOR "thumbnails" PATH_SEPARATOR "small" PATH_SEPARATOR,
+	"assets" PATH_SEPARATOR "thumbnails" PATH_SEPARATOR "large" PATH_SEPARATOR
+};
+
+/// <summary>
+/// The size that each thumbnail variant is generated at, indexed by ThumbnailSize.
+/// They match the sizes the thumbnails are drawn at by the tiles and the film info panel.
+/// </summary>
+static const uint32_t g_thumbnailSizes[][2] = {
+	{ 200, 300 },
+	{ 350, 525 }
+};
+
+static bool fileExists(const std::string& path)
+{
+	return std::ifstream(path).good();
+}
+
+/// <summary>
+/// Creates every folder on the way to the given file. Folders that already exist are left alone.
+/// </summary>
+static void createFolders(const std::string& filePath)
+{
+	for (size_t i = filePath.find_first_of("\\/"); i != std::string::npos; i = filePath.find_first_of("\\/", i + 1))
+	{
+		const std::string folder = filePath.substr(0, i);
+
+#ifdef _WIN32
+		_mkdir(folder.c_str());
+#else
+		mkdir(folder.c_str(), 0755);
+#endif
+	}
+}
+
+/// <summary>
+/// Writes a pre-scaled copy of a thumbnail, so that this and every later run can load it instead of the original.
+/// Only happens the first time the app runs, or when thumbnails have been added since. If the original can't be
+/// scaled, a NO_THUMBNAIL_SUFFIX marker is written instead.
+/// </summary>
+/// <param name="original">The original image, empty if it couldn't be loaded</param>
+/// <param name="variant">Path that the pre-scaled copy is written to</param>
+/// <param name="size">Which variant is written</param>
+/// <returns>False if there is no point in the copy, or if it couldn't be made</returns>
+static bool generateThumbnail(const Image& original, const std::string& variant, ThumbnailSize size)
+{
+	const uint32_t width = g_thumbnailSizes[static_cast<int>(size)][0];
+	const uint32_t height = g_thumbnailSizes[static_cast<int>(size)][1];
+
+	createFolders(variant);
+
+	// Images are never scaled up, so an original that is already small enough is used as it is
+	if (original.getWidth() <= width && original.getHeight() <= height)
+	{
+		std::ofstream(variant + NO_THUMBNAIL_SUFFIX);
+		return false;
+	}
+
+	// A failed write is not marked, it may work on the next run
+	return original.downscale(width, height).savePng(variant);
+}
+
 /// <summary>
 /// Sets the film's name.
 /// </summary>
@@ -26,46 +118,96 @@ void Film::setDirector(std::string&& director)
 }
 
 /// <summary>
-/// Sets the path of the image that will be displayed as the film thumbnail.
+/// Sets the image that will be displayed as the film thumbnail.
+/// The original image is usually far bigger than any size it is drawn at, so for each
+/// ThumbnailSize we look for a pre-scaled copy of it. Missing copies are generated later by
+/// generateNextThumbnails, and until then their handle stands for the original. The paths are
+/// registered right away so that drawing never touches them.
 /// </summary>
-/// <param name="thumbnail">Path to thumbnail image</param>
+/// <param name="filename">File name of the thumbnail image inside the assets folder</param>
 /// <returns></returns>
-void Film::setThumbnail(std::string&& thumbnail)
+void Film::setThumbnail(const std::string& filename)
 {
-	m_thumbnail = std::move(thumbnail);
+	TextureRegistry* pTextures = TextureRegistry::getInstance();
+
+	const std::string original = "assets" PATH_SEPARATOR + filename;
+	bool isVariantMissing = false;
+
+	m_thumbnailFile = filename;
+
+	for (int i = 0; i < static_cast<int>(ThumbnailSize::COUNT); ++i)
+	{
+		const std::string variant = g_thumbnailFolders[i] + filename;
+		m_thumbnails[i] = pTextures->registerTexture(variant);
+
+		if (!fileExists(variant))
+		{
+			pTextures->setPath(m_thumbnails[i], original);
+			isVariantMissing |= !fileExists(variant + NO_THUMBNAIL_SUFFIX);
+		}
+	}
+
+	// The headless backend never loads a texture, so there is nothing to gain from the copies
+#ifndef AUEBFLIX_HEADLESS
+	if (isVariantMissing)
+	{
+		g_filmsMissingThumbnails.emplace_back(this);
+	}
+#endif
 }
 
 /// <summary>
-/// Breaks down the given description to lines.
-/// This is done because the sgg library refuses to cooperate with new-line characters so we have to do this process ourselves.
+/// Generates the missing pre-scaled thumbnails of the next film that needs them, and points the
+/// film's thumbnail handles to them. Called once per frame, so that the originals are decoded one at a time
+/// while the window is already up, instead of all of them before it is created.
 /// </summary>
-/// <param name="description"></param>
-void Film::setDescription(const std::string& description)
+void Film::generateNextThumbnails(void)
 {
-	const size_t descriptionLength = description.length();
+	if (g_filmsMissingThumbnails.empty())
+	{
+		return;
+	}
 
-	constexpr int lineLength = 80;
+	Film* pFilm = g_filmsMissingThumbnails.front();
+	g_filmsMissingThumbnails.pop_front();
 
-	int lastNewLine = 0;
+	const std::string original = "assets" PATH_SEPARATOR + pFilm->m_thumbnailFile;
 
-	for (int i = 0; i < descriptionLength; ++i)
+	// A missing original is not marked, so its copies are made once it has been added
+	if (!fileExists(original))
 	{
-		if ((i + 1) % lineLength == 0 || i == descriptionLength - 1)
-		{
-			std::string line = description.substr(lastNewLine, i - lastNewLine);
+		return;
+	}
 
-			if (i < descriptionLength - 1 && description[i] != ' ')
-			{
-				line += '-';
-			}
+	Image image;
+	image.loadPng(original);
 
-			lastNewLine = i;
+	for (int i = 0; i < static_cast<int>(ThumbnailSize::COUNT); ++i)
+	{
+		const std::string variant = g_thumbnailFolders[i] + pFilm->m_thumbnailFile;
+
+		if (fileExists(variant) || fileExists(variant + NO_THUMBNAIL_SUFFIX))
+		{
+			continue;
+		}
 
-			m_description.emplace_back(std::move(line));
+		if (generateThumbnail(image, variant, static_cast<ThumbnailSize>(i)))
+		{
+			TextureRegistry::getInstance()->setPath(pFilm->m_thumbnails[i], variant);
 		}
 	}
 }
 
+/// <summary>
+/// Sets the description of the film. The sgg library can't draw new-line characters,
+/// so the description is broken into lines by the TextLayoutCache when it is drawn.
+/// </summary>
+/// <param name="description"></param>
+void Film::setDescription(const std::string& description)
+{
+	m_description = description;
+}
+
 /// <summary>
 /// 
 /// </summary>
@@ -133,7 +275,7 @@ void Film::loadFilms(const char* path)
 		pFilm->setGenres(std::move(info.genres));
 		pFilm->setDescription(info.description);
 		pFilm->setYear(std::stoi(info.year));
-		pFilm->setThumbnail(std::move("assets\\" + info.thumbnail));
+		pFilm->setThumbnail(info.thumbnail);
 		pFilm->setStars(std::move(info.stars));
 		pFilm->setDirector(std::move(info.director));
 		g_loadedFilms.emplace_back(pFilm);
@@ -151,6 +293,7 @@ void Film::unloadFilms(void)
 	}
 
 	g_loadedFilms.clear();
+	g_filmsMissingThumbnails.clear();
 }
 
 // Returns a reference to the set containing the loaded films.
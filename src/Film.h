@@ -5,11 +5,19 @@
 #include <list>
 #include <set>
 
+#include "win/texture_registry.h"
+
+/// <summary>
+/// The pre-scaled thumbnail variants a film can be drawn with.
+/// SMALL is meant for the FILM_WIDTH x FILM_HEIGHT tiles, LARGE for the film info panel.
+/// </summary>
+enum class ThumbnailSize { SMALL, LARGE, COUNT };
+
 class Film
 {
 public:
 	void setName(std::string&& name);
-	void setThumbnail(std::string&& thumbnail);
+	void setThumbnail(const std::string& filename);
 	void setDescription(const std::string& description);
 	void setStars(std::set<std::string>&& stars);
 	void setDirector(std::string&& director);
@@ -21,6 +29,7 @@ public:
 
 	static void loadFilms(const char* path);
 	static void unloadFilms(void);
+	static void generateNextThumbnails(void);
 	static std::list<Film*>& getLoadedFilms(void);
 
 	inline const std::set<std::string>& getStars(void) const noexcept
@@ -43,13 +52,14 @@ public:
 	}
 
 	/// <summary>
-	/// Returns the path of the thumbnail.
+	/// Returns the texture of the thumbnail variant of the given size.
+	/// Until the pre-scaled variant has been generated, or if it can't be, the handle stands for the original image.
 	/// </summary>
-	/// <param name=""></param>
+	/// <param name="size">Which variant should be returned</param>
 	/// <returns></returns>
-	inline std::string getThumbnail(void)
+	inline TextureHandle getThumbnail(ThumbnailSize size) const noexcept
 	{
-		return m_thumbnail;
+		return m_thumbnails[static_cast<int>(size)];
 	}
 
 	/// <summary>
@@ -71,22 +81,24 @@ public:
 	}
 
 	/// <summary>
-	/// Returns a const reference to the lines of the description of the film.
+	/// Returns a const reference to the description of the film. It's a single paragraph,
+	/// which is broken into lines when it is laid out for drawing.
 	/// </summary>
 	/// <returns></returns>
-	inline const std::vector<std::string>& getDescription(void) const noexcept
+	inline const std::string& getDescription(void) const noexcept
 	{
 		return m_description;
 	}
 
 private:
 	std::string m_name = "";
-	std::string m_thumbnail = "";
+	TextureHandle m_thumbnails[static_cast<int>(ThumbnailSize::COUNT)] = {};
+	std::string m_thumbnailFile = "";
 	std::string m_director = "";
 
 	std::set<std::string> m_genres;
 	std::set<std::string> m_stars;
-	std::vector<std::string> m_description;
+	std::string m_description;
 
 	int m_year = 0;
 };
@@ -27,9 +27,18 @@ void FilmButton::draw(void)
 
 void FilmButton::setFilm(Film* pFilm)
 {
+	// Pooled buttons get rebound to the same film very often while scrolling,
+	// so we avoid redrawing them if nothing changed
+	if (m_pFilm == pFilm)
+	{
+		return;
+	}
+
 	m_pFilm = pFilm;
-	m_bgBrush.texture = m_pFilm->getThumbnail();
+	m_bgBrush.texture = m_pFilm->getThumbnail(ThumbnailSize::SMALL);
 	m_bgBrush.outline_opacity = 0.0F;
+
+	invalidate();
 }
 
 /// <summary>
@@ -66,10 +75,6 @@ long FilmButton::onMouseEnter(MouseMessageInfo* mmi)
 	killTimer(SCALE_DOWN_TIMER);
 	addTimer(SCALE_UP_TIMER, 20);
 
-	// We want to let the parent know that the cursor is inside its
-	// client area so that it shows the scroll right/left buttons.
-	getParent()->onMouseEnter(mmi);
-
 	return 0L;
 }
 
@@ -78,48 +83,15 @@ long FilmButton::onMouseLeft(MouseMessageInfo* mmi)
 	killTimer(SCALE_UP_TIMER);
 	addTimer(SCALE_DOWN_TIMER, 20);
 
-	Widget* pParent = getParent();
-
-	// If the mouse left the film button, then there are 2 possibilities:
-	// 1. The cursor entered the FilmOrganizer client area, which means that
-	//    it shouldn't receive a mouse left message and therefore hide the scroll buttons
-	// 2. The cursor is now outside the FilmOrganizer client area, but since the cursor
-	//    was inside a FilmButton, the FilmOrganizer won't receive a mouse left message,
-	//    so we have to call the function ourselves.
-	if (Widget::getCursorWidget() != pParent)
-	{
-		getParent()->onMouseLeft(mmi);
-	}
-
 	return 0L;
 }
 
 /// <summary>
-/// Creates a FilmInfoPanel object displaying the information held in the film structure,
-/// and sends a CUSTOM message to the main window telling it to hide the organizer labels,
-/// because they're drawn on top of EVERYTHING for some god forsaken reason.
+/// Creates a FilmInfoPanel object displaying the information held in the film structure.
 /// </summary>
 /// <returns>Return code</returns>
 void FilmButton::onClick(void)
 {
 	// This is deleted in AppWindow::onCustom
 	new FilmInfoPanel(m_pFilm, getRoot());
-
-	CustomMessageInfo* pInfo = new CustomMessageInfo;
-	pInfo->id = HIDE_DRAWN_TEXT;
-	pInfo->data = nullptr;
-
-	Message message = {};
-	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
-	getRoot()->postMessage(message);
-
-
-	pInfo = new CustomMessageInfo;
-	pInfo->id = SHOW_RESULT_TEXT;
-	pInfo->data = (void*)false;
-
-	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
-	getParent()->postMessage(message);
 }
\ No newline at end of file
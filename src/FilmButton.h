@@ -4,9 +4,6 @@
 #include "Film.h"
 #include "win/renderer.h"
 
-#define HIDE_DRAWN_TEXT 100
-#define SHOW_RESULT_TEXT 110
-
 class FilmButton : public Button
 {
 public:
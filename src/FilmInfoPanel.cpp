@@ -1,8 +1,16 @@
 #include "FilmInfoPanel.h"
 #include "FilmButton.h"
 
+#include "win/text_layout.h"
+
 #define FADE_IN_TIMER 100
 
+#define TEXT_LEFT 510.F
+#define TEXT_RIGHT_MARGIN 40.F
+
+// The description has to end above the director's name
+#define DESCRIPTION_MAX_LINES 7
+
 FilmInfoPanel::FilmInfoPanel(Film* film, Widget* pRoot)
 	: Widget(pRoot->getSize(), Point(0, 0), pRoot), m_Renderer(this)
 {
@@ -14,7 +22,11 @@ FilmInfoPanel::FilmInfoPanel(Film* film, Widget* pRoot)
 
 	// So obviously we want the initial opacity to be 0, otherwise there would be
 	// no point in fading the widget in
-	m_opacity = 0.0F;
+	setOpacity(0.0F);
+
+	// The background image is stretched over the whole panel, which is as big as the window,
+	// so nothing below the panel has to be drawn once it has faded in
+	m_isOpaque = true;
 
 	// If the genres given are: "Adventure", "Fantasy", "SciFi"
 	// we want to produce the string "Adventure,    Fantasy,     SciFi"
@@ -35,21 +47,19 @@ FilmInfoPanel::FilmInfoPanel(Film* film, Widget* pRoot)
 	// Inside removeFromParent in widget.h the cleanup method is called, which deletes this pointer
 	m_pCloseButton = new PanelCloseButton(Size(48, 48), Point(10, 10), this);
 	m_pCloseButton->bringToTop();
-	m_pCloseButton->setOpacity(0.0F);
 
 	initBrushes();
 }
 
 void FilmInfoPanel::initBrushes(void)
 {
-	m_bgImageBrush.texture = "assets\\main-bg.png";
+	m_bgImageBrush.texture = TextureRegistry::getInstance()->registerTexture("assets\\main-bg.png");
 	m_bgImageBrush.outline_opacity = 0.0F;
-	m_bgImageBrush.fill_opacity = m_opacity;
 	m_bgImageBrush.fill_color[0] = 0.4F;
 	m_bgImageBrush.fill_color[1] = 0.4F;
 	m_bgImageBrush.fill_color[2] = 0.4F;
 
-	m_thumbnailBrush.texture = m_pFilm->getThumbnail();
+	m_thumbnailBrush.texture = m_pFilm->getThumbnail(ThumbnailSize::LARGE);
 	m_thumbnailBrush.outline_opacity = 0.0F;
 
 	m_descBrush.fill_color[0] = 0.8F;
@@ -59,8 +69,8 @@ void FilmInfoPanel::initBrushes(void)
 
 long FilmInfoPanel::onTimer(int timer_id)
 {
-	m_opacity += 0.125F;
-	m_pCloseButton->setOpacity(m_opacity);
+	// The close button inherits the opacity of the panel
+	setOpacity(m_opacity + 0.125F);
 
 	if (m_opacity >= 1.F) 
 	{
@@ -68,8 +78,7 @@ long FilmInfoPanel::onTimer(int timer_id)
 
 		// This is 99.9% not necessary since we increase m_opacity by a power of 2
 		// but I don't have the energy to think right now so I'll do this to be certain everything is ok
-		m_opacity = 1.F;
-		m_pCloseButton->setOpacity(1.F);
+		setOpacity(1.F);
 	}
 	
 	return 0L;
@@ -99,8 +108,6 @@ void FilmInfoPanel::drawBackgroundImage(void)
 	const float width = static_cast<float>(getWidth());
 	const float height = static_cast<float>(getHeight());
 
-	m_bgImageBrush.fill_opacity = m_opacity;
-
 	m_Renderer.drawRect(
 		width / 2.F,
 		height / 2.F,
@@ -112,103 +119,96 @@ void FilmInfoPanel::drawBackgroundImage(void)
 
 void FilmInfoPanel::drawTitle(void)
 {
-	graphics::Brush brush;
-	brush.fill_opacity = m_opacity;
+	Brush brush;
 
-	m_Renderer.drawText(510.F, getHeight() / 2.F - 320 + 90, 40.F, m_pFilm->getName(), brush);
+	drawTruncatedText(TEXT_LEFT, getHeight() / 2.F - 320 + 90, 40.F, m_pFilm->getName(), brush);
 }
 
 void FilmInfoPanel::drawGenres(void)
 {
-	graphics::Brush brush;
-	brush.fill_opacity = m_opacity;
+	Brush brush;
 
-	m_Renderer.drawText(510.F, getHeight() / 2.F - 320 + 120, 20.F, std::to_string(m_pFilm->getYear()), brush);
+	m_Renderer.drawText(TEXT_LEFT, getHeight() / 2.F - 320 + 120, 20.F, std::to_string(m_pFilm->getYear()), brush);
 }
 
 void FilmInfoPanel::drawYear(void)
 {
-	graphics::Brush brush;
-	brush.fill_opacity = m_opacity;
+	Brush brush;
 
-	m_Renderer.drawText(575.F, getHeight() / 2.F - 320 + 120, 20.F, genre_string, brush);
+	drawTruncatedText(575.F, getHeight() / 2.F - 320 + 120, 20.F, genre_string, brush);
 }
 
 void FilmInfoPanel::drawDescription(void)
 {
 	const float yOffset = getHeight() / 2.F - 300 + 150;
 
-	const std::vector<std::string>& description = m_pFilm->getDescription();
-	const size_t lineCount = description.size();
+	const float maxWidth = getWidth() - TEXT_LEFT - TEXT_RIGHT_MARGIN;
+	const TextLayout& layout = TextLayoutCache::getInstance()->getLayout(m_pFilm->getDescription(), 25.F, maxWidth, DESCRIPTION_MAX_LINES);
+	const size_t lineCount = layout.lines.size();
 
-	m_descBrush.fill_opacity = m_opacity;
-
-	for (int i = 0; i < lineCount; ++i)
+	for (size_t i = 0; i < lineCount; ++i)
 	{
-		m_Renderer.drawText(510.F, yOffset + i * 30, 25.F, description[i], m_descBrush);
+		m_Renderer.drawText(TEXT_LEFT, yOffset + i * 30, 25.F, layout.lines[i], m_descBrush);
 	}
 }
 
 void FilmInfoPanel::drawThumbnail(void)
 {
-	m_thumbnailBrush.fill_opacity = m_opacity;
-
 	m_Renderer.drawRect(300.F, getHeight() / 2.F, 350.F, 525.F, m_thumbnailBrush);
 }
 
 void FilmInfoPanel::drawDirector(void)
 {
-	graphics::Brush brush;
-	brush.fill_opacity = m_opacity;
+	Brush brush;
 
-	m_Renderer.drawText(510.F, 450, 30.F, m_pFilm->getDirector(), brush);
+	drawTruncatedText(TEXT_LEFT, 450, 30.F, m_pFilm->getDirector(), brush);
 }
 
 void FilmInfoPanel::drawStars(void)
 {
-	graphics::Brush brush;
-	brush.fill_opacity = m_opacity;
+	Brush brush;
 
 	int counter = 0;
 
 	for (const std::string& star : m_pFilm->getStars())
 	{
-		m_Renderer.drawText(510.F, 520.F + counter++ * 35.F, 30.F, star, brush);
+		drawTruncatedText(TEXT_LEFT, 520.F + counter++ * 35.F, 30.F, star, brush);
 	}
 }
 
+/// <summary>
+/// Draws text on a single line, cutting it short with an ellipsis if it would run past the right side of the panel
+/// </summary>
+void FilmInfoPanel::drawTruncatedText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush)
+{
+	const float maxWidth = getWidth() - pos_x - TEXT_RIGHT_MARGIN;
+	const TextLayout& layout = TextLayoutCache::getInstance()->getLayout(text, size, maxWidth, 1);
+
+	m_Renderer.drawText(pos_x, pos_y, size, layout.lines.front(), brush);
+}
+
 /// <summary>
 /// Sends a message to the root window (AppWindow) that implies that the FilmInfoPanel widget should be closed
 /// </summary>
 /// <param name=""></param>
 void PanelCloseButton::onClick(void)
 {
-	CustomMessageInfo* pMessageInfo = new CustomMessageInfo();
+	CustomMessageInfo* pMessageInfo = MessageGenerator::getInstance()->allocateCustomMessageInfo();
 	pMessageInfo->id = CLOSE_FILM_INFO_PANEL_MESSAGE;
 	// A pointer to the panel info widget is needed by AppWindow in order to close it when the message is received
 	pMessageInfo->data = getParent(); 
 
 	Message message = {};
 	message.code = Message::Code::CUSTOM;
-	message.data = pMessageInfo;
+	message.custom = pMessageInfo;
 	getRoot()->postMessage(message);
-
-
-	pMessageInfo = new CustomMessageInfo;
-	pMessageInfo->id = SHOW_RESULT_TEXT;
-	pMessageInfo->data = (void*)true;
-
-	message.code = Message::Code::CUSTOM;
-	message.data = pMessageInfo;
-	getParent()->getParent()->postMessage(message);
 }
 
 void PanelCloseButton::draw(void)
 {
-	graphics::Brush brush;
-	brush.texture = "assets\\x.png";
+	Brush brush;
+	brush.texture = m_texture;
 	brush.outline_opacity = 0.F;
-	brush.fill_opacity = m_opacity;
 
 	if (m_isHovered)
 	{
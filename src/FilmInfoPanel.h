@@ -11,12 +11,15 @@ class PanelCloseButton : public Button
 {
 public:
 	PanelCloseButton(const Size& size, const Point& point, Widget* pParent)
-		: Button(size, point, pParent) {}
+		: Button(size, point, pParent), m_texture(TextureRegistry::getInstance()->registerTexture("assets\\x.png")) {}
 		
 	void draw(void) override;
 
 protected:
 	void onClick(void) override;
+
+private:
+	TextureHandle m_texture;
 };
 
 class FilmInfoPanel : public Widget
@@ -41,12 +44,14 @@ private:
 	inline void drawDirector(void);
 	inline void drawStars(void);
 
+	void drawTruncatedText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush);
+
 private:
 	std::string genre_string;
 
-	graphics::Brush m_bgImageBrush;
-	graphics::Brush m_thumbnailBrush;
-	graphics::Brush m_descBrush;
+	Brush m_bgImageBrush;
+	Brush m_thumbnailBrush;
+	Brush m_descBrush;
 
 	Film* m_pFilm = nullptr;
 	Renderer m_Renderer;
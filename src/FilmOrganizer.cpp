@@ -1,6 +1,7 @@
 #include "FilmOrganizer.h"
 
 #define FILM_MARGIN 20
+#define FILM_SPACING (FILM_WIDTH + FILM_MARGIN)
 
 #define SCROLL_RIGHT_TIMER 300
 #define SCROLL_RIGHT_MESSAGE 300
@@ -12,6 +13,9 @@ FilmOrganizer::FilmOrganizer(const Size& size, const Point& point, Widget* pWidg
 {
 	setOutlineColor(0, 0, 0);
 
+	// The pooled film buttons on either end of the row are partly or entirely outside of it
+	m_clipsChildren = true;
+
 	m_pLeftButton = new FilmOrganizerScrollButton(Size(50, size.height - 40), Point(0, 40), this);
 	m_pLeftButton->setDirection(FOSBDirection::LEFT);
 
@@ -26,9 +30,9 @@ FilmOrganizer::FilmOrganizer(const Size& size, const Point& point, Widget* pWidg
 
 FilmOrganizer::~FilmOrganizer(void)
 {
-	for (auto it = m_FilmButtons.begin(); it != m_FilmButtons.end(); ++it)
+	for (FilmButton* pButton : m_FilmButtons)
 	{
-		delete (*it);
+		delete pButton;
 	}
 
 	delete m_pLeftButton;
@@ -65,16 +69,11 @@ long FilmOrganizer::onTimer(int timer_id)
 	m_distanceScrolled += scroll;
 
 	// We do the actual scrolling here
-	for (FilmButton* pButton : m_FilmButtons) 
-	{
-		pButton->setRelativePositionX(
-			pButton->getRelativePositionX() + scroll
-		);
-	}
+	layoutFilmButtons();
 
 	// We want to scroll the films by FILM_WIDTH + FILM_MARGIN so that they're aligned
 	// properly, so if the distance is divisible by the said distance, we may stop
-	if (m_distanceScrolled % (FILM_WIDTH + FILM_MARGIN) == 0)
+	if (m_distanceScrolled % FILM_SPACING == 0)
 	{
 		killTimer(SCROLL_LEFT_TIMER);
 		killTimer(SCROLL_RIGHT_TIMER);
@@ -89,13 +88,16 @@ long FilmOrganizer::onTimer(int timer_id)
 
 void FilmOrganizer::updateScrollButtons(void)
 {
-	if (m_FilmButtons.empty()) {
+	if (m_films.empty()) {
 		m_pLeftButton->hide();
 		m_pRightButton->hide();
 		return;
 	}
 
-	if (m_FilmButtons.front()->getRelativePositionX() > 0) {
+	const int firstFilmX = FILM_MARGIN + m_distanceScrolled;
+	const int lastFilmX = firstFilmX + ((int)m_films.size() - 1) * FILM_SPACING;
+
+	if (firstFilmX > 0) {
 		m_pLeftButton->disable();
 		m_pLeftButton->hide();
 	} else {
@@ -103,7 +105,7 @@ void FilmOrganizer::updateScrollButtons(void)
 		m_pLeftButton->show();
 	}
 
-	if (m_FilmButtons.back()->getRelativePositionX() + FILM_WIDTH < (int32_t)getWidth()) {
+	if (lastFilmX + FILM_WIDTH < (int32_t)getWidth()) {
 		m_pRightButton->disable();
 		m_pRightButton->hide();
 	} else {
@@ -113,36 +115,72 @@ void FilmOrganizer::updateScrollButtons(void)
 }
 
 /// <summary>
-/// Creates a FilmButton for the given film and adds it to the end of the 'list' in the UI
+/// Adds the given film to the end of the 'list' in the UI.
+/// A FilmButton is only created if the button pool isn't big enough to cover the organizer yet.
 /// </summary>
 /// <param name="film">Film object containing the required information</param>
 void FilmOrganizer::addFilm(Film* film)
 {
-	FilmButton* pFilmButton = new FilmButton(
-		Size(FILM_WIDTH, FILM_HEIGHT),
-		Point((int)m_FilmButtons.size() * (FILM_MARGIN + FILM_WIDTH) + FILM_MARGIN, 60),
-		this
-	);
-	
-	m_pLeftButton->bringToTop();
-	m_pRightButton->bringToTop();
+	m_films.emplace_back(film);
 
-	pFilmButton->setFilm(film);
-	m_FilmButtons.emplace_back(pFilmButton);
+	if ((int)m_FilmButtons.size() < getFilmButtonPoolSize())
+	{
+		// Deleted in the destructor
+		FilmButton* pFilmButton = new FilmButton(Size(FILM_WIDTH, FILM_HEIGHT), Point(0, 60), this);
+		m_FilmButtons.emplace_back(pFilmButton);
 
+		m_pLeftButton->bringToTop();
+		m_pRightButton->bringToTop();
+	}
+
+	layoutFilmButtons();
 	updateScrollButtons();
 	m_pLeftButton->hide();
 	m_pRightButton->hide();
 }
 
+/// <summary>
+/// The number of FilmButtons needed to cover the width of the organizer, plus one
+/// extra button on each side so that nothing pops into view while scrolling.
+/// </summary>
+int FilmOrganizer::getFilmButtonPoolSize(void) const noexcept
+{
+	return ((int)getWidth() + FILM_SPACING - 1) / FILM_SPACING + 2;
+}
+
+/// <summary>
+/// Positions the pooled FilmButtons according to the distance scrolled and binds each of
+/// them to the film that is supposed to be at that position.
+/// </summary>
+void FilmOrganizer::layoutFilmButtons(void)
+{
+	const int poolSize = (int)m_FilmButtons.size();
+
+	// Index of the film that is bound to the first button of the pool. We start one film
+	// before the left-most visible one, but we never go past the end of the list, so that
+	// every pooled button always has a film.
+	const int maxFirstIndex = std::max(0, (int)m_films.size() - poolSize);
+	const int firstIndex = std::min(std::max(-m_distanceScrolled / FILM_SPACING - 1, 0), maxFirstIndex);
+
+	for (int i = 0; i < poolSize; ++i)
+	{
+		const int filmIndex = firstIndex + i;
+
+		m_FilmButtons[i]->setFilm(m_films[filmIndex]);
+		m_FilmButtons[i]->setRelativePositionX(filmIndex * FILM_SPACING + FILM_MARGIN + m_distanceScrolled);
+	}
+}
+
 void FilmOrganizer::setLabel(const std::string& str)
 {
 	m_genreLabel = str;
+
+	invalidate();
 }
 
 long FilmOrganizer::onMouseEnter(MouseMessageInfo* mmi)
 {
-	if (!m_FilmButtons.empty())
+	if (!m_films.empty())
 	{
 		if (m_pLeftButton->isEnabled())
 			m_pLeftButton->show();
@@ -156,7 +194,11 @@ long FilmOrganizer::onMouseEnter(MouseMessageInfo* mmi)
 
 long FilmOrganizer::onMouseLeft(MouseMessageInfo* mmi)
 {
-	if (!m_FilmButtons.empty() && !hasChild(Widget::getCursorWidget()))
+	Widget* pCursorWidget = Widget::getCursorWidget();
+
+	// The buttons stay visible as long as the cursor is somewhere inside the organizer,
+	// e.g. when it moves from a FilmButton back to the organizer itself
+	if (!m_films.empty() && pCursorWidget != this && !hasChild(pCursorWidget))
 	{
 		if (m_pLeftButton->isEnabled())
 			m_pLeftButton->hide();
@@ -168,28 +210,45 @@ long FilmOrganizer::onMouseLeft(MouseMessageInfo* mmi)
 	return 0L;
 }
 
-void FilmOrganizer::draw(void)
+/// <summary>
+/// The cursor entering or leaving one of the children (the film buttons and the scroll buttons)
+/// is treated as the cursor entering or leaving the organizer.
+/// </summary>
+bool FilmOrganizer::onBubbleMessage(const Message& message, Widget* pTarget)
 {
-	drawBackground();
+	MouseMessageInfo mmi = message.mouse;
 
-	if (m_showText)
+	switch (message.code)
 	{
-		Renderer renderer(this);
+	case Message::Code::MOUSE_ENTER:
+		onMouseEnter(&mmi);
+		break;
 
-		graphics::Brush brush;
-		brush.fill_color[0] = 1.F;
-		brush.fill_color[1] = 1.F;
-		brush.fill_color[2] = 1.F;
+	case Message::Code::MOUSE_LEFT:
+		onMouseLeft(&mmi);
+		break;
 
-		renderer.drawText(FILM_MARGIN, 40, 30, m_genreLabel, brush);
+	default:
+		break;
 	}
 
-	drawChildren();
+	return false;
 }
 
-void FilmOrganizer::showText(bool show)
+void FilmOrganizer::draw(void)
 {
-	m_showText = show;
+	drawBackground();
+
+	Renderer renderer(this);
+
+	Brush brush;
+	brush.fill_color[0] = 1.F;
+	brush.fill_color[1] = 1.F;
+	brush.fill_color[2] = 1.F;
+
+	renderer.drawText(FILM_MARGIN, 40, 30, m_genreLabel, brush);
+
+	drawChildren();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -207,6 +266,9 @@ FilmOrganizerScrollButton::FilmOrganizerScrollButton(const Size& size, const Poi
 	m_bgBrush.gradient_dir_u = 1.F;
 	m_bgBrush.gradient_dir_v = 0.F;
 	m_bgBrush.outline_opacity = 0.0F;
+
+	m_leftArrowTexture = TextureRegistry::getInstance()->registerTexture("assets\\left-arrow.png");
+	m_rightArrowTexture = TextureRegistry::getInstance()->registerTexture("assets\\right-arrow.png");
 }
 
 void FilmOrganizerScrollButton::setDirection(FOSBDirection dir)
@@ -216,30 +278,16 @@ void FilmOrganizerScrollButton::setDirection(FOSBDirection dir)
 
 void FilmOrganizerScrollButton::onClick(void)
 {
-	CustomMessageInfo* pInfo = new CustomMessageInfo;
+	CustomMessageInfo* pInfo = MessageGenerator::getInstance()->allocateCustomMessageInfo();
 	pInfo->id = (m_direction == FOSBDirection::LEFT) ? SCROLL_LEFT_MESSAGE : SCROLL_RIGHT_MESSAGE;
 	pInfo->data = NULL;
 
 	Message message = {};
 	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
+	message.custom = pInfo;
 	getParent()->postMessage(message);
 }
 
-long FilmOrganizerScrollButton::onMouseEnter(MouseMessageInfo* mmi)
-{
-	getParent()->onMouseEnter(mmi);
-
-	return 0L;
-}
-
-long FilmOrganizerScrollButton::onMouseLeft(MouseMessageInfo* mmi)
-{
-	getParent()->onMouseLeft(mmi);
-
-	return 0L;
-}
-
 void FilmOrganizerScrollButton::draw(void)
 {
 	if (m_opacity == 0.0F)
@@ -247,18 +295,18 @@ void FilmOrganizerScrollButton::draw(void)
 
 	Renderer renderer(this);
 
-	graphics::Brush arrowBrush;
+	Brush arrowBrush;
 	arrowBrush.outline_opacity = 0.0F;
 
 	if (m_direction == FOSBDirection::LEFT)
 	{	
-		arrowBrush.texture = "assets\\left-arrow.png";
+		arrowBrush.texture = m_leftArrowTexture;
 		m_bgBrush.fill_secondary_opacity = 0.0F;
 	}
 
 	else 
 	{
-		arrowBrush.texture = "assets\\right-arrow.png";
+		arrowBrush.texture = m_rightArrowTexture;
 		m_bgBrush.fill_opacity = 0.0F;
 	}
 
@@ -3,7 +3,7 @@
 #include "win/widget.h"
 #include "FilmButton.h"
 
-#include <list>
+#include <vector>
 
 #define FILM_WIDTH 200
 #define FILM_HEIGHT 300
@@ -18,14 +18,13 @@ public:
 	void setDirection(FOSBDirection dir);
 	void draw(void) override;
 
-	long onMouseEnter(MouseMessageInfo* mmi);
-	long onMouseLeft(MouseMessageInfo* mmi);
-
 protected:
 	void onClick(void) override;
 
 private:
 	FOSBDirection m_direction = FOSBDirection::RIGHT;
+	TextureHandle m_leftArrowTexture;
+	TextureHandle m_rightArrowTexture;
 };
 
 class FilmOrganizer : public Widget
@@ -36,23 +35,32 @@ public:
 
 	void draw(void) override;
 
-	void showText(bool show);
-
 	long onCustom(CustomMessageInfo* info);
 	long onTimer(int timer_id);
 	long onMouseEnter(MouseMessageInfo* mmi);
 	long onMouseLeft(MouseMessageInfo* mmi);
+	bool onBubbleMessage(const Message& message, Widget* pTarget) override;
 
 	void addFilm(Film* pFilm);
 	void setLabel(const std::string& str);
 
 private:
 	void updateScrollButtons(void);
+	void layoutFilmButtons(void);
+	int getFilmButtonPoolSize(void) const noexcept;
 
 private:
-	std::list<FilmButton*> m_FilmButtons;
+	/// <summary>
+	/// Every film that belongs in this organizer, in the order it was added.
+	/// </summary>
+	std::vector<Film*> m_films;
+
+	/// <summary>
+	/// Only enough FilmButtons to cover the visible part of the organizer (plus one on each side)
+	/// are ever created. As the organizer scrolls they are moved and given different films.
+	/// </summary>
+	std::vector<FilmButton*> m_FilmButtons;
 	int m_distanceScrolled = 0;
-	bool m_showText = true;
 
 	std::string m_genreLabel = "";
 
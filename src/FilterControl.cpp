@@ -13,7 +13,10 @@ FilterControl::FilterControl(const Point& point, Widget* pParent)
 
 	setBackgroundColor(0.0F, 0.0F, 0.F);
 	setOutlineColor(0.3F, 0.0F, 0.0F);
-	setOpacity(0.8F);
+
+	// Only the background is see-through, the controls on top of it are opaque
+	m_bgBrush.fill_opacity = 0.8F;
+	m_bgBrush.outline_opacity = 0.8F;
 
 	m_pSearchTextEdit = new TextEdit(Size(300, 40), Point(padding, padding), this);
 	m_pSearchTextEdit->setPlaceholderText("Film Title/Protagonist/Director");
@@ -176,33 +179,15 @@ std::set<std::string> FilterControl::getSelectedGenres(void)
 	return selectedGenres;
 }
 
-void FilterControl::showText(bool show)
-{
-	m_isTextVisible = show;
-
-	for (GenreButton* pButton : m_genreButtons)
-	{
-		pButton->showText(show);
-	}
-
-	m_pToSlider->showText(show);
-	m_pFromSlider->showText(show);
-	m_pSearchTextEdit->showText(show);
-	m_pSearchButton->showText(show);
-}
-
 void FilterControl::draw(void)
 {
 	drawBackground();
 
-	if (m_isTextVisible)
-	{
-		graphics::Brush brush;
+	Brush brush;
 
-		Renderer renderer(this);
-		renderer.drawText(30, 195, 25, "From", brush);
-		renderer.drawText(50, 265, 25, "To", brush);
-	}
+	Renderer renderer(this);
+	renderer.drawText(30, 195, 25, "From", brush);
+	renderer.drawText(50, 265, 25, "To", brush);
 
 	drawChildren();
 }
\ No newline at end of file
@@ -21,8 +21,6 @@ public:
 
 	std::list<Film*> searchFilms(void);
 
-	void showText(bool show);
-
 private:
 	static bool queryMatchesFilm(const std::string& query, const Film* pFilm);
 
@@ -37,7 +35,5 @@ private:
 	YearSlider* m_pToSlider = nullptr;
 	SearchButton* m_pSearchButton = nullptr;
 	GenreButton* m_genreButtons[6];
-
-	bool m_isTextVisible = true;
 };
 
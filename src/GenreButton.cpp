@@ -4,6 +4,8 @@
 void GenreButton::setGenre(const char* genre)
 {
 	m_genre = genre;
+
+	invalidate();
 }
 
 void GenreButton::onClick(void)
@@ -37,23 +39,15 @@ void GenreButton::draw(void)
 
 	drawBackground();
 
-	if (m_isTextVisible)
-	{
-		graphics::Brush brush;
-
-		if (m_isActivated)
-		{
-			brush.fill_color[0] = 0.0F;
-			brush.fill_color[1] = 0.0F;
-			brush.fill_color[2] = 0.0F;
-		}
+	Brush brush;
 
-		Renderer renderer(this);
-		renderer.drawText(10.F, 20.F, 20.F, m_genre, brush);
+	if (m_isActivated)
+	{
+		brush.fill_color[0] = 0.0F;
+		brush.fill_color[1] = 0.0F;
+		brush.fill_color[2] = 0.0F;
 	}
-}
 
-void GenreButton::showText(bool show)
-{
-	m_isTextVisible = show;
+	Renderer renderer(this);
+	renderer.drawText(10.F, 20.F, 20.F, m_genre, brush);
 }
\ No newline at end of file
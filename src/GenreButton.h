@@ -9,7 +9,6 @@ public:
 		: Button(size, point, pParent) {}
 
 	void setGenre(const char* genre);
-	void showText(bool show);
 
 	inline std::string getGenre(void) {
 		return m_genre; 
@@ -26,6 +25,5 @@ protected:
 
 private:
 	bool m_isActivated = false;
-	bool m_isTextVisible = true;
 	std::string m_genre = "";
 };
\ No newline at end of file
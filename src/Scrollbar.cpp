@@ -21,6 +21,9 @@ Scrollbar::Scrollbar(int scrollDistance, Widget* pParent)
 	// This value is completely arbitrary, it works well so we use it lol
 	m_jump = std::min(25, scrollDistance);
 
+	m_upArrowTexture = TextureRegistry::getInstance()->registerTexture("assets\\up-arrow.png");
+	m_downArrowTexture = TextureRegistry::getInstance()->registerTexture("assets\\down-arrow.png");
+
 	setBackgroundColor(42 / 255.F, 42 / 255.F, 42 / 255.F);
 	setOutlineColor(42 / 255.F, 42 / 255.F, 42 / 255.F);
 }
@@ -253,7 +256,7 @@ void Scrollbar::draw(void)
 {
 	drawBackground();
 
-	graphics::Brush brush;
+	Brush brush;
 	brush.outline_opacity = 0;
 
 	if (!m_isHoveringBar) 
@@ -289,7 +292,7 @@ void Scrollbar::draw(void)
 		brush.fill_color[2] = 1.0F;
 	}
 
-	brush.texture = "assets\\up-arrow.png";
+	brush.texture = m_upArrowTexture;
 	
 
 	m_Renderer.drawRect(SCROLL_BUTTON_WIDTH / 2.F, SCROLL_BUTTON_HEIGHT / 2.F, SCROLL_BUTTON_WIDTH, SCROLL_BUTTON_HEIGHT, brush);
@@ -297,7 +300,7 @@ void Scrollbar::draw(void)
 
 	if (m_isBotBtnHovered)
 	{
-		brush.texture = "";
+		brush.texture = NO_TEXTURE;
 		brush.fill_color[0] = 120 / 255.F;
 		brush.fill_color[1] = 120 / 255.F;
 		brush.fill_color[2] = 120 / 255.F;
@@ -312,7 +315,7 @@ void Scrollbar::draw(void)
 		brush.fill_color[2] = 1.0F;
 	}
 
-	brush.texture = "assets\\down-arrow.png";
+	brush.texture = m_downArrowTexture;
 
 	m_Renderer.drawRect(SCROLL_BUTTON_WIDTH / 2.F, getHeight() - SCROLL_BUTTON_HEIGHT / 2.F, (float)SCROLL_BUTTON_WIDTH, (float)SCROLL_BUTTON_HEIGHT, brush);
 }
\ No newline at end of file
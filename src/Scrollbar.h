@@ -55,6 +55,9 @@ private:
 
 	int m_prevCursorY = 0;
 
+	TextureHandle m_upArrowTexture;
+	TextureHandle m_downArrowTexture;
+
 	Renderer m_Renderer;
 };
 
@@ -8,11 +8,6 @@ SearchButton::SearchButton(const Size& size, const Point& point, Widget* pWidget
 	setOutlineColor(0.0F, 0.F, 0.F);
 }
 
-void SearchButton::showText(bool show)
-{
-	m_isTextVisible = show;
-}
-
 void SearchButton::draw(void)
 {
 	if (m_isHovered)
@@ -35,24 +30,21 @@ void SearchButton::draw(void)
 
 	drawBackground();
 
-	if (m_isTextVisible)
-	{
-		graphics::Brush brush;
+	Brush brush;
 
-		Renderer renderer(this);
-		renderer.drawText(120, 35, 25, "Search", brush);
-	}
+	Renderer renderer(this);
+	renderer.drawText(120, 35, 25, "Search", brush);
 }
 
 void SearchButton::onClick(void)
 {
-	CustomMessageInfo* pInfo = new CustomMessageInfo;
+	CustomMessageInfo* pInfo = MessageGenerator::getInstance()->allocateCustomMessageInfo();
 	pInfo->data = nullptr;
 	pInfo->id = SEARCH_FILMS_BUTTON_PRESSED;
 
 	Message message = {};
 	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
+	message.custom = pInfo;
 
 	getRoot()->postMessage(message);
 }
\ No newline at end of file
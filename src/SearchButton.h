@@ -10,12 +10,8 @@ public:
 	SearchButton(const Size& size, const Point& point, Widget* pWidget);
 
 	void draw(void) override;
-	void showText(bool show);
 
 protected:
 	void onClick(void) override;
-
-private:
-	bool m_isTextVisible = true;
 };
 
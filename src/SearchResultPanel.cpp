@@ -5,28 +5,40 @@
 
 #define FADE_IN_TIMER 100
 
+#define FILMS_PER_ROW 5
+#define FILM_SPACING_X (FILM_WIDTH + 20)
+#define FILM_SPACING_Y (FILM_HEIGHT + 20)
+
+SearchResultScrollbar::SearchResultScrollbar(int maxScroll, SearchResultPanel* pPanel)
+	: GenericScrollbar(maxScroll, pPanel), m_pPanel(pPanel)
+{
+
+}
+
+/// <summary>
+/// Scrolls the sibling widgets and then moves the pooled FilmButtons to the rows that are now visible.
+/// </summary>
+/// <param name="dist"></param>
+void SearchResultScrollbar::scroll(int dist)
+{
+	GenericScrollbar::scroll(dist);
+
+	m_pPanel->layoutFilmButtons();
+}
+
 /// <summary>
-/// Sends a CLOSE_SEARCH_RESULTS and a SHOW_MAIN_UI custom message to the root widget.
+/// Sends a CLOSE_SEARCH_RESULTS custom message to the root widget.
 /// </summary>
 /// <param name=""></param>
 void SearchResultCloseButton::onClick(void)
 {
-	CustomMessageInfo* pInfo = new CustomMessageInfo;
+	CustomMessageInfo* pInfo = MessageGenerator::getInstance()->allocateCustomMessageInfo();
 	pInfo->id = CLOSE_SEARCH_RESULTS;
 	pInfo->data = nullptr;
 
 	Message message = {};
 	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
-	getRoot()->postMessage(message);
-
-
-	pInfo = new CustomMessageInfo;
-	pInfo->id = SHOW_MAIN_UI;
-	pInfo->data = (void*)true;
-
-	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
+	message.custom = pInfo;
 	getRoot()->postMessage(message);
 }
 
@@ -36,22 +48,17 @@ SearchResultPanel::SearchResultPanel(const Size& size, const Point& point, Widge
 	setOutlineColor(0.F, 0.F, 0.F);
 	setBackgroundColor(0.F, 0.F, 0.F);
 
+	// The rows of films scroll past the top and the bottom of the panel
+	m_clipsChildren = true;
+
+	// The black background covers the whole window, so once the panel has faded in
+	// the home screen below it doesn't have to be drawn
+	m_isOpaque = true;
+
 	hide();
 	addTimer(FADE_IN_TIMER, 15);
 
 	m_pCloseButton = new SearchResultCloseButton(Size(48, 48), Point(10, 10), this);
-
-	// We'll send a message to the main window telling it to hide all the
-	// text that is currently being drawn in order to avoid having the text drawn
-	// on top of the search result panel
-	CustomMessageInfo* pInfo = new CustomMessageInfo();
-	pInfo->id = HIDE_DRAWN_TEXT;
-	pInfo->data = (void*)true;
-
-	Message message = {};
-	message.code = Message::Code::CUSTOM;
-	message.data = pInfo;
-	getRoot()->postMessage(message);
 }
 
 SearchResultPanel::~SearchResultPanel(void)
@@ -79,69 +86,37 @@ void SearchResultPanel::cleanupFilmButtons(void)
 /// <returns>Return code</returns>
 long SearchResultPanel::onTimer(int timer_id)
 {
+	// The film buttons inherit the opacity of the panel, so there's nothing else to fade
 	setOpacity(m_opacity + 0.25F);
 
-	for (FilmButton* pButton : m_filmButtons)
-	{
-		pButton->setOpacity(m_opacity + 0.25F);
-	}
-
 	if (m_opacity >= 1.F)
 	{
 		setOpacity(1.0F);
 		killTimer(FADE_IN_TIMER);
-
-		CustomMessageInfo* pInfo = new CustomMessageInfo;
-		pInfo->id = SHOW_MAIN_UI;
-		pInfo->data = (void*)false;
-
-		Message message = {};
-		message.code = Message::Code::CUSTOM;
-		message.data = pInfo;
-		getRoot()->postMessage(message);
 	}
 
 	return 0L;
 }
 
 /// <summary>
-/// 
+/// Displays the given films in a grid. Only the FilmButtons needed to fill the visible rows
+/// are created, so the cost of this function doesn't depend on the number of results.
 /// </summary>
 /// <param name="films"></param>
 void SearchResultPanel::setFilms(const std::list<Film*>& films)
 {
-	constexpr int filmsPerRow = 5;
 	const size_t filmCount = films.size();
 
 	cleanupFilmButtons();
 
+	m_films.assign(films.begin(), films.end());
 	m_resultText = std::to_string(filmCount) + " result" + (filmCount != 1 ? "s found" : " found");;
-	
-	int i = 0;
-
-	for (Film* pFilm : films)
-	{
-		// This is deleted in the destructor, or during a call to cleanupFilmButtons (in case 
-		// setFilms is called twice for the same object, although it shouldn't)
-		FilmButton* pFilmButton = new FilmButton(
-			Size(FILM_WIDTH, FILM_HEIGHT),
-			Point(150 + (i % filmsPerRow) * (FILM_WIDTH + 20), 100 + (i / filmsPerRow) * (FILM_HEIGHT + 20)),
-			this
-		);
-
-		pFilmButton->setFilm(pFilm);
-		pFilmButton->setOutlineColor(0.F, 0.F, 0.F);
-		pFilmButton->hide();
-
-		m_filmButtons.emplace_back(pFilmButton);
-
-		++i;
-	}
 
 	// We'll only create a scrollbar if there are at least 2 rows of films.
 	// For that reason, after we delete the old scrollbar, we must set the pointer to null,
 	// because there is a chance we won't create a new scrollbar, in which case if we call
 	// this function again we'll delete a dangling pointer.
+	// This has to happen before the buttons are laid out, since the layout depends on the scroll distance.
 
 	if (m_pScrollbar)
 	{
@@ -149,39 +124,85 @@ void SearchResultPanel::setFilms(const std::list<Film*>& films)
 		m_pScrollbar = nullptr;
 	}
 
-	if (filmCount > filmsPerRow)
+	const size_t poolSize = std::min(filmCount, (size_t)getFilmButtonPoolSize());
+
+	for (size_t i = 0; i < poolSize; ++i)
 	{
-		m_pScrollbar = new GenericScrollbar(((int)films.size() / filmsPerRow) * 300, this);
+		// This is deleted in the destructor, or during a call to cleanupFilmButtons (in case 
+		// setFilms is called twice for the same object, although it shouldn't)
+		FilmButton* pFilmButton = new FilmButton(Size(FILM_WIDTH, FILM_HEIGHT), Point(0, 0), this);
+		pFilmButton->setOutlineColor(0.F, 0.F, 0.F);
+
+		m_filmButtons.emplace_back(pFilmButton);
 	}
+
+	layoutFilmButtons();
+
+	if (filmCount > FILMS_PER_ROW)
+	{
+		m_pScrollbar = new SearchResultScrollbar(((int)filmCount / FILMS_PER_ROW) * 300, this);
+	}
+
+	invalidate();
 }
 
-void SearchResultPanel::showText(bool show)
+/// <summary>
+/// The number of FilmButtons needed to fill every row that can be visible at once,
+/// plus one extra row above and below so that nothing pops into view while scrolling.
+/// </summary>
+int SearchResultPanel::getFilmButtonPoolSize(void) const noexcept
 {
-	m_isTextVisible = show;
+	const int visibleRows = ((int)getHeight() + FILM_SPACING_Y - 1) / FILM_SPACING_Y;
+
+	return (visibleRows + 2) * FILMS_PER_ROW;
 }
 
-void SearchResultPanel::draw(void)
+/// <summary>
+/// Binds the pooled FilmButtons to the films in the rows around the scrolled position and moves them there.
+/// </summary>
+void SearchResultPanel::layoutFilmButtons(void)
 {
-	drawBackground();
+	const int scrollDistance = m_pScrollbar ? m_pScrollbar->getScrollDistance() : 0;
+	const int filmCount = (int)m_films.size();
+	const int poolSize = (int)m_filmButtons.size();
 
-	if (m_isTextVisible)
-	{
-		int scrollDist = (m_pScrollbar ? m_pScrollbar->getScrollDistance() : 0);
+	const int rowCount = (filmCount + FILMS_PER_ROW - 1) / FILMS_PER_ROW;
+	const int poolRows = (poolSize + FILMS_PER_ROW - 1) / FILMS_PER_ROW;
 
-		Renderer renderer(this);
-		graphics::Brush brush;
-		renderer.drawText(550.F, 60.F - scrollDist, 40.F, m_resultText, brush);
-	}
+	// We start one row above the top-most visible one, but never so far down that the pool
+	// runs past the last row.
+	const int firstRow = std::min(std::max(scrollDistance / FILM_SPACING_Y - 1, 0), std::max(0, rowCount - poolRows));
 
-	drawChildren();
+	for (int i = 0; i < poolSize; ++i)
+	{
+		FilmButton* pButton = m_filmButtons[i];
+		const int filmIndex = firstRow * FILMS_PER_ROW + i;
+
+		// The last row may not be full, in which case the remaining buttons are moved
+		// above the panel where they can't be seen or clicked
+		if (filmIndex >= filmCount)
+		{
+			pButton->setRelativePosition(Point(0, -2 * FILM_HEIGHT));
+			continue;
+		}
+
+		pButton->setFilm(m_films[filmIndex]);
+		pButton->setRelativePosition(Point(
+			150 + (filmIndex % FILMS_PER_ROW) * FILM_SPACING_X,
+			100 + (filmIndex / FILMS_PER_ROW) * FILM_SPACING_Y - scrollDistance
+		));
+	}
 }
 
-long SearchResultPanel::onCustom(CustomMessageInfo* pInfo)
+void SearchResultPanel::draw(void)
 {
-	if (pInfo->id == SHOW_RESULT_TEXT)
-	{
-		showText(static_cast<bool>(pInfo->data));
-	}
+	drawBackground();
 
-	return 0L;
+	int scrollDist = (m_pScrollbar ? m_pScrollbar->getScrollDistance() : 0);
+
+	Renderer renderer(this);
+	Brush brush;
+	renderer.drawText(550.F, 60.F - scrollDist, 40.F, m_resultText, brush);
+
+	drawChildren();
 }
\ No newline at end of file
@@ -8,8 +8,8 @@
 #include "GenericScrollbar.h"
 
 #include <list>
+#include <vector>
 
-#define SHOW_MAIN_UI 300
 #define CLOSE_SEARCH_RESULTS 301
 
 class SearchResultCloseButton : public PanelCloseButton
@@ -22,30 +22,56 @@ private:
 	void onClick(void) override;
 };
 
+class SearchResultPanel;
+
+/// <summary>
+/// Scrolls the search results and lets the panel recycle the FilmButtons
+/// that have moved out of view.
+/// </summary>
+class SearchResultScrollbar : public GenericScrollbar
+{
+public:
+	SearchResultScrollbar(int maxScroll, SearchResultPanel* pPanel);
+
+protected:
+	void scroll(int dist) override;
+
+private:
+	SearchResultPanel* m_pPanel;
+};
+
 class SearchResultPanel : public Widget
 {
+	friend class SearchResultScrollbar;
+
 public:
 	SearchResultPanel(const Size& size, const Point& point, Widget* pParent);
 	~SearchResultPanel(void);
 
-	void showText(bool show);
-
 	long onTimer(int timer_id) override;
-	long onCustom(CustomMessageInfo* pInfo) override;
 
 	void draw(void) override;
 	void setFilms(const std::list<Film*>& films);
 
 private:
 	void cleanupFilmButtons(void);
+	void layoutFilmButtons(void);
+	int getFilmButtonPoolSize(void) const noexcept;
 
 private:
-	std::list<FilmButton*> m_filmButtons;
+	/// <summary>
+	/// Every film in the search results, in the order they are displayed.
+	/// </summary>
+	std::vector<Film*> m_films;
+
+	/// <summary>
+	/// Only the rows that intersect the panel (plus one row above and below) have FilmButtons.
+	/// These are reused for different films as the results are scrolled.
+	/// </summary>
+	std::vector<FilmButton*> m_filmButtons;
 
 	SearchResultCloseButton* m_pCloseButton = nullptr;
-	GenericScrollbar* m_pScrollbar = nullptr;
+	SearchResultScrollbar* m_pScrollbar = nullptr;
 
 	std::string m_resultText;
-
-	bool m_isTextVisible = true;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Slider.h"
 
 #include <cassert>
+#include <cmath>
 
 /// <summary>
 /// Sets the range of integers the slider's value can be included in.
@@ -21,6 +22,8 @@ void Slider::setRange(int min, int max) noexcept
 	m_max = max;
 
 	m_value = horizontalPositionToValue(m_thumbPosX);
+
+	invalidate();
 }
 
 void Slider::setValue(int value) noexcept
@@ -30,6 +33,8 @@ void Slider::setValue(int value) noexcept
 		m_thumbPosX = valueToHorizontalPosition(value);
 		m_value = value;
 	}
+
+	invalidate();
 }
 
 /// <summary>
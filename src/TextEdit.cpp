@@ -1,11 +1,11 @@
 #include "TextEdit.h"
 #include "win/renderer.h"
 
+#include <cstring>
+
 #define CARET_TOGGLE_TIME_MS 500
 
 #define CARET_BLINK_TIMER 100
-#define INITIAL_REPEAT_TIMER 101
-#define FASTER_REPEAT_TIMER 102
 
 #define DISPLAYED_CHARACTER_COUNT 30
 
@@ -15,22 +15,17 @@ TextEdit::TextEdit(const Size& size, const Point& point, Widget* pParent)
 	: Widget(size, point, pParent)
 {
 	memset(m_buffer, 0, sizeof(m_buffer));
-	memset(&repeatedKeyInfo.keyInfo, 0, sizeof(KeyMessageInfo));
 
 	setOutlineColor(0.0F, 0.0F, 0.0F);
 	setBackgroundColor(42 / 255.F, 42 / 255.F, 42 / 255.F);
 }
 
+/// <summary>
+/// Handles both actual key presses and the repeated presses of a key that is held down,
+/// which are generated by the MessageGenerator.
+/// </summary>
 long TextEdit::onKeyPressed(KeyMessageInfo* pInfo)
 {
-	if (!repeatedKeyInfo.m_isKeyDown)
-	{
-		repeatedKeyInfo.m_isKeyDown = true;
-		repeatedKeyInfo.keyInfo = *pInfo;
-
-		addTimer(INITIAL_REPEAT_TIMER, 400);
-	}
-
 	// The library can't print newline characters so we'll make this text edit only have 1 line because
 	// I can't be bothered enough to implement multiple lines
 	if (pInfo->scancode == graphics::scancode_t::SCANCODE_RETURN)
@@ -81,16 +76,6 @@ void TextEdit::updateDisplayedText(void)
 	displayedText = std::string(m_buffer).substr(std::max(m_iCaretIndex - DISPLAYED_CHARACTER_COUNT, 0), DISPLAYED_CHARACTER_COUNT);
 }
 
-long TextEdit::onKeyReleased(KeyMessageInfo*)
-{
-	repeatedKeyInfo.m_isKeyDown = false;
-
-	killTimer(INITIAL_REPEAT_TIMER);
-	killTimer(FASTER_REPEAT_TIMER);
-
-	return 0L;
-}
-
 void TextEdit::insertCharacter(KeyMessageInfo* pInfo)
 {
 	if (m_iCaretIndex < m_bufferIndex)
@@ -190,65 +175,39 @@ long TextEdit::onLostFocus(void)
 	return 0L;
 }
 
-long TextEdit::onTimer(int timer_id)
-{
-	switch (timer_id)
-	{
-	case INITIAL_REPEAT_TIMER:
-		killTimer(INITIAL_REPEAT_TIMER);
-		addTimer(FASTER_REPEAT_TIMER, 25);
-		break;
-
-	case FASTER_REPEAT_TIMER:
-		return onKeyPressed(&repeatedKeyInfo.keyInfo);
-	}
-
-	return 0L;
-}
-
-/// <summary>
-/// Toggles text drawing in order to avoid overlapping
-/// </summary>
-/// <param name="show"></param>
-void TextEdit::showText(bool show)
-{
-	m_isTextVisible = show;
-}
-
 void TextEdit::draw(void)
 {
 	drawBackground();
 
-	if (m_isTextVisible)
-	{
-		Renderer renderer(this);
+	Renderer renderer(this);
 
-		if (!m_buffer[0])
+	if (!m_buffer[0])
+	{
+		if (!placeholder.empty())
 		{
-			if (!placeholder.empty())
-			{
-				graphics::Brush brush;
-				brush.fill_color[0] = 0.75F;
-				brush.fill_color[1] = 0.75F;
-				brush.fill_color[2] = 0.75F;
-
-				renderer.drawText(10, 30, 20, placeholder, brush);
-			}
+			Brush brush;
+			brush.fill_color[0] = 0.75F;
+			brush.fill_color[1] = 0.75F;
+			brush.fill_color[2] = 0.75F;
+
+			renderer.drawText(10, 30, 20, placeholder, brush);
 		}
+	}
 
-		else
-		{
-			graphics::Brush brush;
-			brush.fill_color[0] = 1.0F;
-			brush.fill_color[1] = 1.0F;
-			brush.fill_color[2] = 1.0F;
+	else
+	{
+		Brush brush;
+		brush.fill_color[0] = 1.0F;
+		brush.fill_color[1] = 1.0F;
+		brush.fill_color[2] = 1.0F;
 
-			renderer.drawText(10, 30, 20, displayedText, brush);
-		}
+		renderer.drawText(10, 30, 20, displayedText, brush);
 	}
 }
 
 void TextEdit::setPlaceholderText(const std::string& placeholder)
 {
 	this->placeholder = placeholder;
+
+	invalidate();
 }
\ No newline at end of file
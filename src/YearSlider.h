@@ -3,6 +3,8 @@
 #include "Slider.h"
 #include "win/renderer.h"
 
+#include <climits>
+
 class YearSlider : public Slider
 {
 public:
@@ -10,14 +12,16 @@ public:
 
 	void draw(void) override;
 
-	void showText(bool show);
-
 private:
 	Renderer m_Renderer;
 
-	graphics::Brush m_lineBrush;
-	graphics::Brush m_thumbBrush;
+	Brush m_lineBrush;
+	Brush m_thumbBrush;
 
-	bool m_showText = true;
+	/// <summary>
+	/// The value drawn above the thumb, and the value it was made from
+	/// </summary>
+	std::string m_valueText;
+	int m_textValue = INT_MIN;
 };
 
@@ -8,21 +8,27 @@
 #include "SearchButton.h"
 #include "GenreButton.h"
 #include "SearchResultPanel.h"
+#include "win/backend.h"
+#include "win/renderer.h"
+#include "win/font_metrics.h"
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
+#define FONT_FILE "assets\\SEGOEUI.ttf"
+
 AppWindow::AppWindow(Size size, std::string title)
 	: Widget(size, Point(0, 0), nullptr)
 {
 	m_pMsgGenerator = MessageGenerator::getInstance();
 
-	graphics::createWindow(size.width, size.height, title);
-	graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
-	graphics::setCanvasSize((float)size.width, (float)size.height);
+	Backend* pBackend = Backend::get();
 
-	graphics::setDrawFunction(std::bind(&AppWindow::draw, this));
-	graphics::setUpdateFunction(std::bind(&AppWindow::update, this, std::placeholders::_1));
-	graphics::setResizeFunction(std::bind(&AppWindow::resize, this, std::placeholders::_1, std::placeholders::_2));
+	pBackend->createWindow(size, title);
+	pBackend->setCallbacks(
+		std::bind(&AppWindow::update, this, std::placeholders::_1),
+		std::bind(&AppWindow::render, this),
+		std::bind(&AppWindow::resize, this, std::placeholders::_1, std::placeholders::_2)
+	);
 
 	initFilmOrganizers();
 	initScrollbar();
@@ -31,7 +37,14 @@ AppWindow::AppWindow(Size size, std::string title)
 	setBackgroundColor(0.0F, 0.0F, 0.0F);
 	setOutlineColor(0.0F, 0.0F, 0.0F);
 
-	graphics::setFont("assets\\SEGOEUI.ttf");
+	TextureRegistry* pTextures = TextureRegistry::getInstance();
+	m_backgroundTexture = pTextures->registerTexture("assets\\main-bg.png");
+	m_logoTexture = pTextures->registerTexture("assets\\auebflix-logo.png");
+	m_mottoTexture = pTextures->registerTexture("assets\\moto.png");
+
+	// Text is measured with the metrics of the same font that the backend draws it with
+	pBackend->setFont(FONT_FILE);
+	FontMetrics::getInstance()->load(FONT_FILE);
 }
 
 AppWindow::~AppWindow(void)
@@ -106,12 +119,16 @@ void AppWindow::initSearchUI(void)
 /// <param name="ms"></param>
 void AppWindow::update(float ms)
 {
-	for (Message& message : m_pMsgGenerator->generateMessages(ms))
+	for (const Message& message : m_pMsgGenerator->generateMessages(ms))
 	{
 		this->postMessage(message);
 	}
 
 	Widget::update(ms);
+
+	m_pMsgGenerator->endFrame();
+
+	Film::generateNextThumbnails();
 }
 
 long AppWindow::onCustom(CustomMessageInfo* pInfo)
@@ -126,22 +143,9 @@ long AppWindow::onCustom(CustomMessageInfo* pInfo)
 		closeSearchResults();
 		break;
 
-	case HIDE_DRAWN_TEXT:
-		showDrawnText(false);
-		break;
-
 	case SEARCH_FILMS_BUTTON_PRESSED:
 		searchFilms();
 		break;
-
-	case SHOW_MAIN_UI:
-		showMainUI(pInfo->data);
-		break;
-
-	case SHOW_RESULT_TEXT:
-		if (m_pSearchResultPanel)
-			m_pSearchResultPanel->showText(static_cast<bool>(pInfo->data));
-		break;
 	}
 
 	return 0L;
@@ -159,8 +163,6 @@ void AppWindow::closeSearchResults(void)
 	// May be deleted again in the destructor so we need to set
 	// this pointer to null in order to avoid deleting a dangling pointer.
 	m_pSearchResultPanel = nullptr;
-
-	showDrawnText(true);
 }
 
 void AppWindow::searchFilms(void)
@@ -176,24 +178,7 @@ void AppWindow::searchFilms(void)
 }
 
 /// <summary>
-/// Shows/Hides the film organizers, the filter UI, and generally anything that is shown in the first screen.
-/// This is done for two reasons:
-///		1. For some reason text is drawn on top of EVERYTHING, so we have to hide it in order to avoid widgets overlapping
-///		2. The program is obviously much faster if we don't draw widgets that aren't visible
-/// </summary>
-/// <param name="show">True if should show, false if should hide</param>
-void AppWindow::showMainUI(bool show)
-{
-	m_pFilterControl->show(show);
-
-	for (const std::pair<std::string, FilmOrganizer*>& orgPair : m_filmOrganizers)
-	{
-		orgPair.second->show(show);
-	}
-}
-
-/// <summary>
-/// Removes the film info panel from the window's children and shows/hides the appropriate children
+/// Removes the film info panel from the window's children
 /// </summary>
 void AppWindow::closeFilmPanel(Widget* pPanel)
 {
@@ -201,31 +186,6 @@ void AppWindow::closeFilmPanel(Widget* pPanel)
 
 	// We allocated the panel inside the film button class, so we must do some cleanup here
 	delete pPanel;
-
-	// If the search result panel isn't null, this means that the FilmInfoPanel
-	// was created from the search results, meaning that the drawn text must not
-	// become visible yet, because the search results are on top.
-	// If the search result panel is visible, then the drawn text will be shown
-	// when it is closed and closeSearchResults() is called.
-	if (!m_pSearchResultPanel)
-	{
-		showDrawnText(true);
-	}
-}
-
-/// <summary>
-/// Shows/Hides all the text that is being drawn in the main ui in order to avoid
-/// drawing text on top of the film info panel and the search results.
-/// </summary>
-/// <param name="show"></param>
-void AppWindow::showDrawnText(bool show)
-{
-	for (auto& pair : m_filmOrganizers)
-	{
-		pair.second->showText(show);
-	}
-
-	m_pFilterControl->showText(show);
 }
 
 
@@ -236,36 +196,38 @@ void AppWindow::draw(void)
 	const int distanceScrolled = m_pScrollbar->getScrollDistance();
 	const float backgroundWidth = static_cast<float>(getWidth()) - m_pScrollbar->getWidth();
 	
-	graphics::Brush brush;
+	Renderer renderer(this);
+
+	Brush brush;
 	brush.outline_opacity = 0.F;
-	brush.texture = "assets\\main-bg.png";
+	brush.texture = m_backgroundTexture;
 
 	// We'll scroll the background image by one fifth of the total distance scrolled
 	// This makes the ui feel more interactive and 3d and idk it looks pretty good
-	graphics::drawRect(backgroundWidth / 2.F, 300.F - distanceScrolled / 5.F, backgroundWidth, backgroundWidth * 9.F / 16.F, brush);
+	renderer.drawRect(backgroundWidth / 2.F, 300.F - distanceScrolled / 5.F, backgroundWidth, backgroundWidth * 9.F / 16.F, brush);
 
 
-	brush.texture = "";
+	brush.texture = NO_TEXTURE;
 	brush.fill_color[0] = 0.F;
 	brush.fill_color[1] = 0.F;
 	brush.fill_color[2] = 0.F;
 
 	// Here we draw the black rectangle that's at the top of the screen
-	graphics::drawRect(backgroundWidth / 2.F, 50.F - distanceScrolled, backgroundWidth, 100.F, brush);
+	renderer.drawRect(backgroundWidth / 2.F, 50.F - distanceScrolled, backgroundWidth, 100.F, brush);
 
 
-	brush.texture = "assets\\auebflix-logo.png";
+	brush.texture = m_logoTexture;
 	brush.fill_color[0] = 1.0F;
 	brush.fill_color[1] = 1.0F;
 	brush.fill_color[2] = 1.0F;
 
 	// and finally we draw the Auebflix logo inside the rectangle
-	graphics::drawRect(backgroundWidth / 2.F, 50.F - distanceScrolled, 349.F, 100.F, brush);
+	renderer.drawRect(backgroundWidth / 2.F, 50.F - distanceScrolled, 349.F, 100.F, brush);
 
 
-	brush.texture = "assets\\moto.png";
+	brush.texture = m_mottoTexture;
 
-	graphics::drawRect(400, 300.F - distanceScrolled, 469, 149, brush);
+	renderer.drawRect(400, 300.F - distanceScrolled, 469, 149, brush);
 
 	drawChildren();
 }
@@ -277,5 +239,5 @@ void AppWindow::resize(int width, int height)
 
 void AppWindow::doMessageLoop()
 {
-	graphics::startMessageLoop();
+	Backend::get()->startMessageLoop();
 }
\ No newline at end of file
@@ -37,11 +37,13 @@ private:
 	/// </summary>
 	std::unordered_map<std::string, FilmOrganizer*> m_filmOrganizers;
 
+	TextureHandle m_backgroundTexture;
+	TextureHandle m_logoTexture;
+	TextureHandle m_mottoTexture;
+
 private:
 	void closeFilmPanel(Widget* pPanel);
 	void closeSearchResults(void);
-	void showDrawnText(bool show);
-	void showMainUI(bool show);
 	void searchFilms(void);
 
 	void initFilmOrganizers(void);
@@ -3,10 +3,255 @@
 
 #include <stdexcept>
 
+#ifdef AUEBFLIX_HEADLESS
+
+#include "win/headless_backend.h"
+#include "win/renderer.h"
+#include "FilmButton.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define BENCHMARK_DEFAULT_FRAMES 3600
+
+#define HIT_TEST_DEFAULT_BUTTONS 400
+#define HIT_TEST_DEFAULT_QUERIES 1000000
+#define HIT_TEST_CONTAINERS 4
+#define HIT_TEST_COLUMNS 20
+#define HIT_TEST_BUTTON_WIDTH 60
+#define HIT_TEST_BUTTON_HEIGHT 90
+#define HIT_TEST_SPACING 8
+
+/// <summary>
+/// Where the cursor is and whether the left button is held during each frame of the benchmark's loop.
+/// The loop hovers over the first row of films, scrolls it, opens a film and closes it again.
+/// </summary>
+static void runBenchmarkFrame(HeadlessBackend& backend, uint64_t frame)
+{
+	const uint64_t step = frame % 300;
+
+	if (step < 60)
+	{
+		// Sweep over the films of the first row
+		backend.setMousePosition(100 + static_cast<int>(step) * 20, 650);
+		backend.setMouseButtons(false, false);
+	}
+	else if (step < 120)
+	{
+		// Click the right scroll button of the first row every few frames
+		backend.setMousePosition(1320, 650);
+		backend.setMouseButtons(step % 10 == 0, false);
+	}
+	else if (step < 210)
+	{
+		// Open a film and let the panel fade in
+		backend.setMousePosition(300, 650);
+		backend.setMouseButtons(step == 130, false);
+	}
+	else
+	{
+		// Close the panel
+		backend.setMousePosition(30, 30);
+		backend.setMouseButtons(step == 220, false);
+	}
+}
+
+/// <summary>
+/// The child under a point as Messenger found it before the children were indexed in a SpatialGrid:
+/// every child is checked, from the top-most to the bottom-most.
+/// </summary>
+/// <param name="point">Point relative to the top left of the root Widget</param>
+static Widget* findChildLinear(const Widget* pParent, const Point& point)
+{
+	const std::list<Widget*>& children = pParent->getChildren();
+
+	for (auto it = children.rbegin(); it != children.rend(); ++it)
+	{
+		const Point ptAbsolute = (*it)->getAbsolutePosition();
+		const Size size = (*it)->getSize();
+
+		if (point.x >= ptAbsolute.x && point.x <= ptAbsolute.x + static_cast<int>(size.width) &&
+			point.y >= ptAbsolute.y && point.y <= ptAbsolute.y + static_cast<int>(size.height))
+		{
+			return *it;
+		}
+	}
+
+	return nullptr;
+}
+
+/// <summary>
+/// Fills a few containers with a grid of FilmButtons each and finds the button under random points,
+/// once with the SpatialGrid of the container and once by checking every child.
+/// Usage: Auebflix --hit-test [buttons per container] [query count]
+/// </summary>
+static int runHitTestBenchmark(int buttonCount, int queryCount)
+{
+	const int rows = (buttonCount + HIT_TEST_COLUMNS - 1) / HIT_TEST_COLUMNS;
+	const Size containerSize(
+		HIT_TEST_COLUMNS * (HIT_TEST_BUTTON_WIDTH + HIT_TEST_SPACING) + HIT_TEST_SPACING,
+		rows * (HIT_TEST_BUTTON_HEIGHT + HIT_TEST_SPACING) + HIT_TEST_SPACING
+	);
+
+	Widget root(Size(containerSize.width, containerSize.height * HIT_TEST_CONTAINERS), Point(0, 0), nullptr);
+	std::vector<Widget*> containers;
+	std::vector<FilmButton*> buttons;
+
+	for (int c = 0; c < HIT_TEST_CONTAINERS; ++c)
+	{
+		Widget* pContainer = new Widget(containerSize, Point(0, c * static_cast<int>(containerSize.height)), &root);
+		containers.push_back(pContainer);
+
+		for (int i = 0; i < buttonCount; ++i)
+		{
+			const Point position(
+				HIT_TEST_SPACING + (i % HIT_TEST_COLUMNS) * (HIT_TEST_BUTTON_WIDTH + HIT_TEST_SPACING),
+				HIT_TEST_SPACING + (i / HIT_TEST_COLUMNS) * (HIT_TEST_BUTTON_HEIGHT + HIT_TEST_SPACING)
+			);
+
+			buttons.push_back(new FilmButton(Size(HIT_TEST_BUTTON_WIDTH, HIT_TEST_BUTTON_HEIGHT), position, pContainer));
+		}
+	}
+
+	// The same points for both, so that they do exactly the same work
+	std::mt19937 random(12345);
+	std::uniform_int_distribution<int> randomX(0, static_cast<int>(containerSize.width) - 1);
+	std::uniform_int_distribution<int> randomY(0, static_cast<int>(containerSize.height) - 1);
+	std::vector<Point> points(queryCount);
+
+	for (int i = 0; i < queryCount; ++i)
+	{
+		const Widget* pContainer = containers[i % HIT_TEST_CONTAINERS];
+		points[i] = Point(randomX(random), pContainer->getAbsolutePositionY() + randomY(random));
+	}
+
+	int gridHits = 0;
+	int linearHits = 0;
+	int mismatches = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < queryCount; ++i)
+	{
+		gridHits += containers[i % HIT_TEST_CONTAINERS]->getChildUnderPoint(points[i]) ? 1 : 0;
+	}
+
+	const double gridTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < queryCount; ++i)
+	{
+		linearHits += findChildLinear(containers[i % HIT_TEST_CONTAINERS], points[i]) ? 1 : 0;
+	}
+
+	const double linearTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	for (int i = 0; i < queryCount; ++i)
+	{
+		const Widget* pContainer = containers[i % HIT_TEST_CONTAINERS];
+
+		if (pContainer->getChildUnderPoint(points[i]) != findChildLinear(pContainer, points[i]))
+		{
+			++mismatches;
+		}
+	}
+
+	printf("hit test: %d containers of %d film buttons, %d queries, %d hits\n", HIT_TEST_CONTAINERS, buttonCount, queryCount, gridHits);
+	printf("spatial grid: %.1f ms (%.1f ns per query)\n", gridTime, gridTime * 1e6 / queryCount);
+	printf("linear scan:  %.1f ms (%.1f ns per query)\n", linearTime, linearTime * 1e6 / queryCount);
+	printf("speedup: %.1fx, %d mismatches\n", linearTime / gridTime, mismatches + (gridHits != linearHits ? 1 : 0));
+
+	for (FilmButton* pButton : buttons)
+	{
+		delete pButton;
+	}
+
+	for (Widget* pContainer : containers)
+	{
+		delete pContainer;
+	}
+
+	return (mismatches == 0 && gridHits == linearHits) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// <summary>
+/// Runs the app without a window, with scripted input and a simulated 60 fps clock, as fast as possible.
+/// Usage: Auebflix [films file] [frame count], or Auebflix --hit-test [buttons per container] [query count]
+/// </summary>
+int main(int argc, char** argv)
+{
+	if (argc > 1 && strcmp(argv[1], "--hit-test") == 0)
+	{
+		HeadlessBackend backend;
+		Backend::set(&backend);
+
+		const int buttonCount = (argc > 2) ? std::atoi(argv[2]) : HIT_TEST_DEFAULT_BUTTONS;
+		const int queryCount = (argc > 3) ? std::atoi(argv[3]) : HIT_TEST_DEFAULT_QUERIES;
+
+		return runHitTestBenchmark(buttonCount, queryCount);
+	}
+
+	const char* filmsPath = (argc > 1) ? argv[1] : "assets/films.txt";
+	const uint64_t frameCount = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : BENCHMARK_DEFAULT_FRAMES;
+
+	try
+	{
+		HeadlessBackend backend;
+		backend.setRecording(false);
+		Backend::set(&backend);
+
+		Film::loadFilms(filmsPath);
+
+		{
+			AppWindow app(Size(1370, 720), "Auebflix");
+
+			backend.setScript([frameCount](HeadlessBackend& backend, uint64_t frame) {
+				runBenchmarkFrame(backend, frame);
+				return frame < frameCount;
+			});
+
+			const auto start = std::chrono::steady_clock::now();
+			app.doMessageLoop();
+			const double wallTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			const HeadlessBackend::DrawStats& stats = backend.getTotalStats();
+			const double frames = static_cast<double>(backend.getFrameCount());
+
+			printf("frames: %llu (%.1f s simulated, %.1f ms real)\n", (unsigned long long)backend.getFrameCount(), backend.getTime() / 1000.0, wallTime);
+			printf("per frame: %.3f ms, %.1f rects, %.1f texts, %.1f lines\n", wallTime / frames, stats.rects / frames, stats.texts / frames, stats.lines / frames);
+
+			const Renderer::BatchStats& batchStats = Renderer::getBatchStats();
+			const double batchFrames = static_cast<double>(batchStats.frames);
+
+			printf("state changes per frame: %.1f before batching, %.1f after\n", batchStats.stateChangesBeforeBatching / batchFrames, batchStats.stateChangesAfterBatching / batchFrames);
+		}
+
+		Film::unloadFilms();
+	}
+
+	catch (std::exception& e)
+	{
+		puts(e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+#else
+
+#include "win/sgg_backend.h"
+
 int main(void)
 {
 	try 
 	{
+		SggBackend backend;
+		Backend::set(&backend);
+
 		Film::loadFilms("assets\\films.txt");
 
 		AppWindow app(Size(1370, 720), "Auebflix");
@@ -22,4 +267,6 @@ int main(void)
 	}
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,16 @@
+#include "backend.h"
+
+/// <summary>
+/// The backend everything is drawn with and all input is read from. Set by main before the app is created.
+/// </summary>
+static Backend* g_pBackend = nullptr;
+
+Backend* Backend::get(void) noexcept
+{
+	return g_pBackend;
+}
+
+void Backend::set(Backend* pBackend) noexcept
+{
+	g_pBackend = pBackend;
+}
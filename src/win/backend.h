@@ -0,0 +1,45 @@
+#pragma once
+
+#include <sgg/graphics.h>
+
+#include "types.h"
+#include "brush.h"
+
+#include <functional>
+#include <string>
+
+/// <summary>
+/// Everything the windowing system needs from the platform: a window, drawing and input.
+/// Renderer, MessageGenerator and AppWindow only talk to the platform through the current backend,
+/// so the whole Widget tree can run either on top of sgg (SggBackend) or without any window
+/// at all (HeadlessBackend), e.g. on a Linux box with no display.
+/// 
+/// Draw calls take our own Brush, whose texture is a TextureRegistry handle. The sgg MouseState
+/// struct is plain data, so it is used by every backend.
+/// </summary>
+class Backend
+{
+public:
+	typedef std::function<void(float)> UpdateFunction;
+	typedef std::function<void(void)> DrawFunction;
+	typedef std::function<void(int, int)> ResizeFunction;
+
+	virtual ~Backend(void) = default;
+
+	static Backend* get(void) noexcept;
+	static void set(Backend* pBackend) noexcept;
+
+	virtual void createWindow(const Size& canvasSize, const std::string& title) = 0;
+	virtual void setFont(const std::string& fontFile) = 0;
+	virtual void setCallbacks(UpdateFunction update, DrawFunction draw, ResizeFunction resize) = 0;
+	virtual void startMessageLoop(void) = 0;
+
+	virtual void drawRect(float center_x, float center_y, float width, float height, const Brush& brush) = 0;
+	virtual void drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush) = 0;
+	virtual void drawLine(float x1, float y1, float x2, float y2, const Brush& brush) = 0;
+
+	virtual void getMouseState(graphics::MouseState& ms) = 0;
+	virtual bool getKeyState(graphics::scancode_t key) = 0;
+	virtual float windowToCanvasX(float x) = 0;
+	virtual float windowToCanvasY(float y) = 0;
+};
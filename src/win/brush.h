@@ -0,0 +1,27 @@
+#pragma once
+
+#include "texture_registry.h"
+
+/// <summary>
+/// Drawing attributes of a shape or a piece of text. The fields mean the same as in graphics::Brush,
+/// except for the texture, which is a handle from the TextureRegistry instead of a path, so that
+/// brushes can be built and copied every frame without allocating. Only the backend converts them
+/// to graphics::Brush.
+/// </summary>
+struct Brush
+{
+	float fill_color[3] = { 1.F, 1.F, 1.F };
+	float fill_secondary_color[3] = { 1.F, 1.F, 1.F };
+	float fill_opacity = 1.F;
+	float fill_secondary_opacity = 1.F;
+
+	float outline_color[3] = { 1.F, 1.F, 1.F };
+	float outline_opacity = 1.F;
+	float outline_width = 1.F;
+
+	TextureHandle texture = NO_TEXTURE;
+
+	bool gradient = false;
+	float gradient_dir_u = 0.F;
+	float gradient_dir_v = 1.F;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "brush.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// <summary>
+/// A single recorded draw call. Positions are relative to the top left corner of the Widget
+/// whose command list the call was recorded into, so the list stays valid when that Widget moves.
+/// </summary>
+struct DrawCommand
+{
+	enum class Type { RECT, TEXT, LINE } type;
+
+	// RECT: center, then width and height. TEXT: position, then size in x2 and width in y2. LINE: both end points.
+	float x1, y1;
+	float x2, y2;
+
+	std::string text;
+	Brush brush;
+
+	/// <summary>
+	/// Identifies the backend state the command needs (type, texture, gradient), so that
+	/// commands with equal keys can be drawn one after the other. Set by the Renderer.
+	/// </summary>
+	uint32_t stateKey;
+
+	/// <summary>
+	/// The clip rectangle of the command, in the same coordinates as the position. Only used if isClipped is set.
+	/// </summary>
+	bool isClipped;
+	float clip_left, clip_top, clip_right, clip_bottom;
+};
+
+typedef std::vector<DrawCommand> DrawCommandList;
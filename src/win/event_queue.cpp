@@ -0,0 +1,214 @@
+#include "event_queue.h"
+
+#define EVENT_QUEUE_INITIAL_CAPACITY 64
+
+/// <summary>
+/// Adds a message to the back of the lane it belongs to.
+/// </summary>
+/// <param name="pTarget">Pointer to the Widget the message was posted to</param>
+/// <param name="message">Reference to the message</param>
+void EventQueue::push(Widget* pTarget, const Message& message)
+{
+	Ring& lane = m_lanes[static_cast<int>(getLane(message.code))];
+
+	if (!coalesce(lane, pTarget, message))
+	{
+		lane.push(pTarget, message);
+	}
+}
+
+/// <summary>
+/// Merges the message into one that is already queued, if possible:
+/// - A MOVING_MOUSE message replaces the position of a MOVING_MOUSE message to the same Widget
+///   that is at the back of the queue, so only the latest position is hit-tested.
+/// - A TIMER message adds its count to a queued message of the same timer, so a timer that
+///   falls behind is caught up in a single call instead of flooding the queue.
+/// </summary>
+/// <returns>True if the message was merged and mustn't be pushed</returns>
+bool EventQueue::coalesce(Ring& lane, Widget* pTarget, const Message& message) noexcept
+{
+	if (lane.count == 0)
+	{
+		return false;
+	}
+
+	if (message.code == Message::Code::MOVING_MOUSE)
+	{
+		Entry& last = lane.entries[(lane.head + lane.count - 1) & (lane.entries.size() - 1)];
+
+		if (last.pTarget == pTarget && last.message.code == Message::Code::MOVING_MOUSE)
+		{
+			last.message.point = message.point;
+			return true;
+		}
+	}
+
+	else if (message.code == Message::Code::TIMER)
+	{
+		for (size_t i = 0; i < lane.count; ++i)
+		{
+			Entry& entry = lane.entries[(lane.head + i) & (lane.entries.size() - 1)];
+
+			if (entry.pTarget == pTarget &&
+				entry.message.timer.handle.slot == message.timer.handle.slot &&
+				entry.message.timer.handle.generation == message.timer.handle.generation)
+			{
+				entry.message.timer.count += message.timer.count;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Removes the oldest message of the given lane.
+/// Messages whose target has been removed with removeTarget are skipped.
+/// </summary>
+/// <param name="lane">The lane to take the message from</param>
+/// <param name="pTarget">Receives the Widget the message was posted to</param>
+/// <param name="message">Receives the message</param>
+/// <returns>False if the lane was empty</returns>
+bool EventQueue::pop(EventLane lane, Widget*& pTarget, Message& message)
+{
+	return m_lanes[static_cast<int>(lane)].pop(pTarget, message);
+}
+
+/// <summary>
+/// Drops every queued message that was posted to the given Widget, e.g. because the Widget is being deleted.
+/// </summary>
+void EventQueue::removeTarget(const Widget* pTarget) noexcept
+{
+	for (Ring& lane : m_lanes)
+	{
+		lane.removeTarget(pTarget);
+	}
+}
+
+bool EventQueue::isEmpty(void) const noexcept
+{
+	for (const Ring& lane : m_lanes)
+	{
+		if (lane.count > 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Copies the CustomMessageInfo of every queued CUSTOM message into the given arena and points the message
+/// to the copy, so that the arena the info was allocated from can be reset while the message is still queued.
+/// </summary>
+/// <param name="arena">The arena that the payloads have to live in from now on</param>
+void EventQueue::moveCustomPayloads(FrameArena& arena)
+{
+	Ring& lane = m_lanes[static_cast<int>(getLane(Message::Code::CUSTOM))];
+
+	for (size_t i = 0; i < lane.count; ++i)
+	{
+		Entry& entry = lane.entries[(lane.head + i) & (lane.entries.size() - 1)];
+
+		if (entry.pTarget && entry.message.code == Message::Code::CUSTOM)
+		{
+			CustomMessageInfo* pCopy = arena.create<CustomMessageInfo>();
+			*pCopy = *entry.message.custom;
+			entry.message.custom = pCopy;
+		}
+	}
+}
+
+bool EventQueue::isEmpty(EventLane lane) const noexcept
+{
+	return m_lanes[static_cast<int>(lane)].count == 0;
+}
+
+/// <summary>
+/// Returns the lane that messages with the given code are queued in.
+/// </summary>
+EventLane EventQueue::getLane(Message::Code code) noexcept
+{
+	switch (code)
+	{
+	case Message::Code::WINDOW_RESIZED:
+	case Message::Code::CUSTOM:
+		return EventLane::LAYOUT;
+
+	case Message::Code::TIMER:
+		return EventLane::TIMER;
+
+	default:
+		return EventLane::INPUT;
+	}
+}
+
+EventQueue::Ring::Ring(void)
+	: entries(EVENT_QUEUE_INITIAL_CAPACITY), head(0), count(0)
+{
+}
+
+void EventQueue::Ring::push(Widget* pTarget, const Message& message)
+{
+	if (count == entries.size())
+	{
+		grow();
+	}
+
+	Entry& entry = entries[(head + count) & (entries.size() - 1)];
+	entry.pTarget = pTarget;
+	entry.message = message;
+
+	++count;
+}
+
+bool EventQueue::Ring::pop(Widget*& pTarget, Message& message)
+{
+	while (count > 0)
+	{
+		const Entry& entry = entries[head];
+
+		head = (head + 1) & (entries.size() - 1);
+		--count;
+
+		if (entry.pTarget)
+		{
+			pTarget = entry.pTarget;
+			message = entry.message;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void EventQueue::Ring::removeTarget(const Widget* pTarget) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Entry& entry = entries[(head + i) & (entries.size() - 1)];
+
+		if (entry.pTarget == pTarget)
+		{
+			entry.pTarget = nullptr;
+		}
+	}
+}
+
+/// <summary>
+/// Doubles the capacity of the ring buffer, moving the entries so that the oldest one is first.
+/// </summary>
+void EventQueue::Ring::grow(void)
+{
+	std::vector<Entry> newEntries(entries.size() * 2);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		newEntries[i] = entries[(head + i) & (entries.size() - 1)];
+	}
+
+	entries.swap(newEntries);
+	head = 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "message.h"
+#include "frame_arena.h"
+
+#include <cstddef>
+#include <vector>
+
+class Widget;
+
+/// <summary>
+/// The lanes of the event queue, from the highest priority to the lowest.
+/// </summary>
+enum class EventLane
+{
+	INPUT,  // Mouse, keyboard and focus messages
+	LAYOUT, // Resize and custom messages
+	TIMER,  // Timer messages, i.e. animations
+	COUNT
+};
+
+/// <summary>
+/// The single queue that every posted message goes through, along with the Widget it was posted to.
+/// Messages are split into lanes by priority, and every lane is a ring buffer, so pushing and popping
+/// never allocates once it has grown to the size needed, and Widgets don't need an inbox of their own.
+/// </summary>
+class EventQueue
+{
+public:
+	EventQueue(void) = default;
+
+	EventQueue(const EventQueue&) = delete;
+	EventQueue& operator=(const EventQueue&) = delete;
+
+	void push(Widget* pTarget, const Message& message);
+	bool pop(EventLane lane, Widget*& pTarget, Message& message);
+	void removeTarget(const Widget* pTarget) noexcept;
+	void moveCustomPayloads(FrameArena& arena);
+
+	bool isEmpty(void) const noexcept;
+	bool isEmpty(EventLane lane) const noexcept;
+
+	static EventLane getLane(Message::Code code) noexcept;
+
+private:
+	struct Entry
+	{
+		Widget* pTarget;
+		Message message;
+	};
+
+	/// <summary>
+	/// Ring buffer of entries, processed in the order they were pushed.
+	/// </summary>
+	struct Ring
+	{
+		Ring(void);
+
+		void push(Widget* pTarget, const Message& message);
+		bool pop(Widget*& pTarget, Message& message);
+		void removeTarget(const Widget* pTarget) noexcept;
+		void grow(void);
+
+		/// <summary>
+		/// The entries. The size is always a power of two.
+		/// </summary>
+		std::vector<Entry> entries;
+
+		/// <summary>
+		/// Index of the oldest entry
+		/// </summary>
+		size_t head;
+		size_t count;
+	};
+
+	static bool coalesce(Ring& lane, Widget* pTarget, const Message& message) noexcept;
+
+private:
+	Ring m_lanes[static_cast<int>(EventLane::COUNT)];
+};
@@ -0,0 +1,208 @@
+#include "font_metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+/// <summary>
+/// Width of a character, as a fraction of the font size, when there are no real metrics to use.
+/// Hardly any character is wider than that, so text laid out without metrics doesn't overflow.
+/// </summary>
+#define FALLBACK_ADVANCE 1.F
+
+/// <summary>
+/// Reads big endian values out of the font file, returning 0 for anything past its end,
+/// so that a damaged file produces wrong widths instead of crashing.
+/// </summary>
+class FontReader
+{
+public:
+	explicit FontReader(const std::vector<uint8_t>& data)
+		: m_data(data) {}
+
+	uint16_t u16(size_t offset) const noexcept
+	{
+		return (offset + 2 <= m_data.size()) ? static_cast<uint16_t>((m_data[offset] << 8) | m_data[offset + 1]) : 0;
+	}
+
+	int16_t s16(size_t offset) const noexcept
+	{
+		return static_cast<int16_t>(u16(offset));
+	}
+
+	uint32_t u32(size_t offset) const noexcept
+	{
+		return (static_cast<uint32_t>(u16(offset)) << 16) | u16(offset + 2);
+	}
+
+	/// <summary>
+	/// Returns the offset of a table, or 0 if the font doesn't have it.
+	/// </summary>
+	size_t findTable(const char* tag) const noexcept
+	{
+		const uint16_t tableCount = u16(4);
+
+		for (uint16_t i = 0; i < tableCount; ++i)
+		{
+			const size_t record = 12 + i * 16;
+
+			if (record + 16 <= m_data.size() && memcmp(&m_data[record], tag, 4) == 0)
+			{
+				return u32(record + 8);
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	const std::vector<uint8_t>& m_data;
+};
+
+/// <summary>
+/// Returns the offset of the format 4 (Unicode BMP) subtable of the cmap table, or 0 if there isn't one.
+/// </summary>
+static size_t findUnicodeCmap(const FontReader& reader, size_t cmap)
+{
+	const uint16_t subtableCount = reader.u16(cmap + 2);
+
+	for (uint16_t i = 0; i < subtableCount; ++i)
+	{
+		const size_t record = cmap + 4 + i * 8;
+		const uint16_t platform = reader.u16(record);
+		const uint16_t encoding = reader.u16(record + 2);
+		const size_t subtable = cmap + reader.u32(record + 4);
+
+		// Windows Unicode BMP, or any Unicode platform encoding
+		if ((platform == 3 && encoding == 1) || platform == 0)
+		{
+			if (reader.u16(subtable) == 4)
+			{
+				return subtable;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/// <summary>
+/// Looks up the glyph of a character in a format 4 cmap subtable. Glyph 0 is the "missing character" glyph.
+/// </summary>
+static uint16_t findGlyph(const FontReader& reader, size_t subtable, uint16_t character)
+{
+	const uint16_t segmentCount = reader.u16(subtable + 6) / 2;
+	const size_t endCodes = subtable + 14;
+	const size_t startCodes = endCodes + segmentCount * 2 + 2;
+	const size_t deltas = startCodes + segmentCount * 2;
+	const size_t rangeOffsets = deltas + segmentCount * 2;
+
+	for (uint16_t i = 0; i < segmentCount; ++i)
+	{
+		if (character > reader.u16(endCodes + i * 2))
+		{
+			continue;
+		}
+
+		const uint16_t start = reader.u16(startCodes + i * 2);
+
+		if (character < start)
+		{
+			return 0;
+		}
+
+		const uint16_t delta = reader.u16(deltas + i * 2);
+		const size_t rangeOffsetPosition = rangeOffsets + i * 2;
+		const uint16_t rangeOffset = reader.u16(rangeOffsetPosition);
+
+		if (rangeOffset == 0)
+		{
+			return static_cast<uint16_t>(character + delta);
+		}
+
+		const uint16_t glyph = reader.u16(rangeOffsetPosition + rangeOffset + (character - start) * 2);
+		return (glyph != 0) ? static_cast<uint16_t>(glyph + delta) : 0;
+	}
+
+	return 0;
+}
+
+FontMetrics* FontMetrics::getInstance(void)
+{
+	static FontMetrics metrics;
+	return &metrics;
+}
+
+FontMetrics::FontMetrics(void)
+{
+	std::fill(std::begin(m_advances), std::end(m_advances), FALLBACK_ADVANCE);
+}
+
+/// <summary>
+/// Reads the advances of the characters from a TrueType font (the head, hhea, hmtx and cmap tables).
+/// Characters that the font doesn't have get the advance of its "missing character" glyph, like sgg draws them.
+/// </summary>
+/// <param name="fontFile">Path of the .ttf file, the same one that is given to the backend</param>
+/// <returns>False if the file couldn't be read or isn't a TrueType font, in which case the metrics don't change</returns>
+bool FontMetrics::load(const std::string& fontFile)
+{
+	std::ifstream file(fontFile, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	const FontReader reader(data);
+
+	const size_t head = reader.findTable("head");
+	const size_t hhea = reader.findTable("hhea");
+	const size_t hmtx = reader.findTable("hmtx");
+	const size_t cmap = reader.findTable("cmap");
+	const size_t unicodeCmap = cmap ? findUnicodeCmap(reader, cmap) : 0;
+
+	const uint16_t unitsPerEm = reader.u16(head + 18);
+	const uint16_t metricCount = reader.u16(hhea + 34);
+
+	if (!head || !hhea || !hmtx || !unicodeCmap || unitsPerEm == 0 || metricCount == 0)
+	{
+		return false;
+	}
+
+	for (int character = 0; character < FONT_METRICS_CHARACTER_COUNT; ++character)
+	{
+		// Glyphs past the last metric record all share its advance, which is how monospaced fonts save space
+		const uint16_t glyph = std::min(findGlyph(reader, unicodeCmap, static_cast<uint16_t>(character)), static_cast<uint16_t>(metricCount - 1));
+
+		m_advances[character] = reader.u16(hmtx + glyph * 4) / static_cast<float>(unitsPerEm);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Returns the width of a string drawn at the given size
+/// </summary>
+float FontMetrics::measure(const std::string& text, float size) const noexcept
+{
+	return measure(text, 0, text.size(), size);
+}
+
+/// <summary>
+/// Returns the width of count characters of a string, starting at first, drawn at the given size
+/// </summary>
+float FontMetrics::measure(const std::string& text, size_t first, size_t count, float size) const noexcept
+{
+	float width = 0.F;
+
+	for (size_t i = first; i < first + count && i < text.size(); ++i)
+	{
+		width += getAdvance(text[i], size);
+	}
+
+	return width;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+
+#define FONT_METRICS_CHARACTER_COUNT 256
+
+/// <summary>
+/// Horizontal metrics of the font that text is drawn with, read from the TrueType file itself,
+/// since sgg can draw text but can't tell how wide it is. Only the advance of each character is
+/// kept, which is all that wrapping and truncating need. Kerning is ignored.
+/// 
+/// Strings are treated as one character per byte (Latin-1), like the rest of the app treats them.
+/// </summary>
+class FontMetrics
+{
+public:
+	static FontMetrics* getInstance(void);
+
+	FontMetrics(const FontMetrics&) = delete;
+	FontMetrics& operator=(const FontMetrics&) = delete;
+
+	bool load(const std::string& fontFile);
+
+	/// <summary>
+	/// Returns how far the pen moves after drawing a character at the given size.
+	/// </summary>
+	inline float getAdvance(char character, float size) const noexcept
+	{
+		return m_advances[static_cast<unsigned char>(character)] * size;
+	}
+
+	float measure(const std::string& text, float size) const noexcept;
+	float measure(const std::string& text, size_t first, size_t count, float size) const noexcept;
+
+private:
+	FontMetrics(void);
+
+private:
+	/// <summary>
+	/// Advance of every character, as a fraction of the font size. Until a font has been loaded,
+	/// or if it couldn't be, every character is assumed to be as wide as the font size.
+	/// </summary>
+	float m_advances[FONT_METRICS_CHARACTER_COUNT];
+};
@@ -0,0 +1,70 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#define FRAME_ARENA_BLOCK_SIZE 4096
+#define FRAME_ARENA_POISON 0xDD
+
+FrameArena::~FrameArena(void)
+{
+	for (Block& block : m_blocks)
+	{
+		delete[] block.pMemory;
+	}
+}
+
+/// <summary>
+/// Returns a pointer to size bytes inside the arena, aligned to alignment.
+/// The memory stays valid until the next call to reset.
+/// </summary>
+/// <param name="size">Number of bytes needed</param>
+/// <param name="alignment">Required alignment, must be a power of two</param>
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+	while (m_currentBlock < m_blocks.size())
+	{
+		Block& block = m_blocks[m_currentBlock];
+
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block.pMemory) + block.used;
+		const size_t padding = (alignment - (address % alignment)) % alignment;
+
+		if (block.used + padding + size <= block.size)
+		{
+			void* pResult = block.pMemory + block.used + padding;
+			block.used += padding + size;
+			return pResult;
+		}
+
+		++m_currentBlock;
+	}
+
+	// None of the existing blocks has enough room left, so a new one is needed.
+	// new[] returns memory aligned for any fundamental type, which covers everything we allocate here
+	Block block;
+	block.size = std::max<size_t>(FRAME_ARENA_BLOCK_SIZE, size);
+	block.pMemory = new char[block.size];
+	block.used = size;
+
+	m_blocks.push_back(block);
+	m_currentBlock = m_blocks.size() - 1;
+
+	return block.pMemory;
+}
+
+/// <summary>
+/// Releases everything that has been allocated since the previous reset.
+/// </summary>
+void FrameArena::reset(void)
+{
+	for (Block& block : m_blocks)
+	{
+#ifdef _DEBUG
+		memset(block.pMemory, FRAME_ARENA_POISON, block.used);
+#endif
+		block.used = 0;
+	}
+
+	m_currentBlock = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// Bump allocator for data that only has to live for a frame or two, like the payload of CUSTOM messages.
+/// Allocating just advances an offset inside a block of memory, and everything that has been allocated
+/// is released at once by reset, without calling any destructors.
+/// 
+/// In debug builds the released memory is poisoned, so that anything still pointing into it
+/// shows up as garbage (0xDD bytes) instead of silently reading stale values.
+/// </summary>
+class FrameArena
+{
+public:
+	FrameArena(void) = default;
+	~FrameArena(void);
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* allocate(size_t size, size_t alignment);
+	void reset(void);
+
+	/// <summary>
+	/// Allocates and value initializes an object of type T inside the arena.
+	/// Only trivially destructible types are allowed, since reset never calls destructors.
+	/// </summary>
+	template <typename T>
+	T* create(void)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "FrameArena never calls destructors");
+		return new (allocate(sizeof(T), alignof(T))) T();
+	}
+
+private:
+	struct Block
+	{
+		char* pMemory;
+		size_t size;
+		size_t used;
+	};
+
+	/// <summary>
+	/// Blocks are kept around after a reset, so once the arena has grown to the
+	/// size needed by a busy frame it doesn't allocate anymore.
+	/// </summary>
+	std::vector<Block> m_blocks;
+
+	/// <summary>
+	/// Index of the block that allocations are currently served from
+	/// </summary>
+	size_t m_currentBlock = 0;
+};
@@ -0,0 +1,212 @@
+#include "headless_backend.h"
+
+HeadlessBackend::HeadlessBackend(float frameTime)
+	: m_frameTime(frameTime)
+{
+}
+
+void HeadlessBackend::createWindow(const Size& canvasSize, const std::string& title)
+{
+}
+
+void HeadlessBackend::setFont(const std::string& fontFile)
+{
+}
+
+void HeadlessBackend::setCallbacks(UpdateFunction update, DrawFunction draw, ResizeFunction resize)
+{
+	m_update = update;
+	m_draw = draw;
+}
+
+/// <summary>
+/// Runs frames until the script returns false. Without a script there is nothing to stop the loop,
+/// so it returns right away.
+/// </summary>
+void HeadlessBackend::startMessageLoop(void)
+{
+	if (!m_script)
+	{
+		return;
+	}
+
+	while (m_script(*this, m_frameCount))
+	{
+		runFrame();
+	}
+}
+
+/// <summary>
+/// Runs the given number of frames with the input that is currently set, ignoring the script.
+/// </summary>
+void HeadlessBackend::runFrames(uint64_t count)
+{
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		runFrame();
+	}
+}
+
+void HeadlessBackend::runFrame(void)
+{
+	m_mouseState.button_left_pressed = m_isLeftDown && !m_mouseState.button_left_down;
+	m_mouseState.button_left_released = !m_isLeftDown && m_mouseState.button_left_down;
+	m_mouseState.button_right_pressed = m_isRightDown && !m_mouseState.button_right_down;
+	m_mouseState.button_right_released = !m_isRightDown && m_mouseState.button_right_down;
+	m_mouseState.button_left_down = m_isLeftDown;
+	m_mouseState.button_right_down = m_isRightDown;
+
+	m_mouseState.prev_pos_x = m_mouseState.cur_pos_x;
+	m_mouseState.prev_pos_y = m_mouseState.cur_pos_y;
+	m_mouseState.cur_pos_x = m_mouseX;
+	m_mouseState.cur_pos_y = m_mouseY;
+	m_mouseState.dragging = m_isLeftDown && (m_mouseState.cur_pos_x != m_mouseState.prev_pos_x || m_mouseState.cur_pos_y != m_mouseState.prev_pos_y);
+
+	m_time += m_frameTime;
+
+	if (m_update)
+	{
+		m_update(m_frameTime);
+	}
+
+	m_drawCalls.clear();
+
+	if (m_draw)
+	{
+		m_draw();
+	}
+
+	++m_frameCount;
+}
+
+void HeadlessBackend::drawRect(float center_x, float center_y, float width, float height, const Brush& brush)
+{
+	++m_totalStats.rects;
+
+	if (m_isRecording)
+	{
+		DrawCall call;
+		call.type = DrawCall::Type::RECT;
+		call.x = center_x;
+		call.y = center_y;
+		call.width = width;
+		call.height = height;
+		call.size = 0.F;
+		call.texture = brush.texture;
+		m_drawCalls.emplace_back(std::move(call));
+	}
+}
+
+void HeadlessBackend::drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush)
+{
+	++m_totalStats.texts;
+
+	if (m_isRecording)
+	{
+		DrawCall call;
+		call.type = DrawCall::Type::TEXT;
+		call.x = pos_x;
+		call.y = pos_y;
+		call.width = 0.F;
+		call.height = 0.F;
+		call.size = size;
+		call.text = text;
+		call.texture = NO_TEXTURE;
+		m_drawCalls.emplace_back(std::move(call));
+	}
+}
+
+void HeadlessBackend::drawLine(float x1, float y1, float x2, float y2, const Brush& brush)
+{
+	++m_totalStats.lines;
+
+	if (m_isRecording)
+	{
+		DrawCall call;
+		call.type = DrawCall::Type::LINE;
+		call.x = x1;
+		call.y = y1;
+		call.width = x2;
+		call.height = y2;
+		call.size = 0.F;
+		call.texture = NO_TEXTURE;
+		m_drawCalls.emplace_back(std::move(call));
+	}
+}
+
+void HeadlessBackend::getMouseState(graphics::MouseState& ms)
+{
+	ms = m_mouseState;
+}
+
+bool HeadlessBackend::getKeyState(graphics::scancode_t key)
+{
+	return key >= 0 && key < HEADLESS_KEY_COUNT && m_keyStates[key];
+}
+
+// There is no window, so the canvas is never scaled
+float HeadlessBackend::windowToCanvasX(float x)
+{
+	return x;
+}
+
+float HeadlessBackend::windowToCanvasY(float y)
+{
+	return y;
+}
+
+void HeadlessBackend::setScript(ScriptFunction script)
+{
+	m_script = script;
+}
+
+/// <summary>
+/// Moves the cursor. The new position is seen by the app during the next frame.
+/// </summary>
+void HeadlessBackend::setMousePosition(int x, int y) noexcept
+{
+	m_mouseX = x;
+	m_mouseY = y;
+}
+
+/// <summary>
+/// Presses or releases the mouse buttons. The change is seen by the app during the next frame.
+/// </summary>
+void HeadlessBackend::setMouseButtons(bool isLeftDown, bool isRightDown) noexcept
+{
+	m_isLeftDown = isLeftDown;
+	m_isRightDown = isRightDown;
+}
+
+void HeadlessBackend::setKeyState(graphics::scancode_t key, bool isPressed) noexcept
+{
+	if (key >= 0 && key < HEADLESS_KEY_COUNT)
+	{
+		m_keyStates[key] = isPressed;
+	}
+}
+
+void HeadlessBackend::setRecording(bool isRecording) noexcept
+{
+	m_isRecording = isRecording;
+}
+
+const std::vector<HeadlessBackend::DrawCall>& HeadlessBackend::getDrawCalls(void) const noexcept
+{
+	return m_drawCalls;
+}
+
+const HeadlessBackend::DrawStats& HeadlessBackend::getTotalStats(void) const noexcept
+{
+	return m_totalStats;
+}
+
+uint64_t HeadlessBackend::getFrameCount(void) const noexcept
+{
+	return m_frameCount;
+}
+
+double HeadlessBackend::getTime(void) const noexcept
+{
+	return m_time;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "backend.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define HEADLESS_DEFAULT_FRAME_TIME (1000.F / 60.F)
+#define HEADLESS_KEY_COUNT 512
+
+/// <summary>
+/// Backend without a window. Draw calls are recorded instead of drawn, input is set by a script,
+/// and time is simulated: every frame advances the clock by a fixed amount, no matter how long it
+/// actually took, so the app runs as fast as the machine allows and always behaves the same way.
+/// </summary>
+class HeadlessBackend : public Backend
+{
+public:
+	struct DrawCall
+	{
+		enum class Type { RECT, TEXT, LINE } type;
+
+		// For lines, (x, y) is the first point and (width, height) the second one
+		float x;
+		float y;
+		float width;
+		float height;
+		float size;
+
+		std::string text;
+		TextureHandle texture;
+	};
+
+	struct DrawStats
+	{
+		uint64_t rects = 0;
+		uint64_t texts = 0;
+		uint64_t lines = 0;
+	};
+
+	/// <summary>
+	/// Called before every frame with the number of frames run so far. Returning false ends the message loop.
+	/// </summary>
+	typedef std::function<bool(HeadlessBackend&, uint64_t frame)> ScriptFunction;
+
+	explicit HeadlessBackend(float frameTime = HEADLESS_DEFAULT_FRAME_TIME);
+
+	void createWindow(const Size& canvasSize, const std::string& title) override;
+	void setFont(const std::string& fontFile) override;
+	void setCallbacks(UpdateFunction update, DrawFunction draw, ResizeFunction resize) override;
+	void startMessageLoop(void) override;
+
+	void drawRect(float center_x, float center_y, float width, float height, const Brush& brush) override;
+	void drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush) override;
+	void drawLine(float x1, float y1, float x2, float y2, const Brush& brush) override;
+
+	void getMouseState(graphics::MouseState& ms) override;
+	bool getKeyState(graphics::scancode_t key) override;
+	float windowToCanvasX(float x) override;
+	float windowToCanvasY(float y) override;
+
+	void setScript(ScriptFunction script);
+	void runFrames(uint64_t count);
+
+	void setMousePosition(int x, int y) noexcept;
+	void setMouseButtons(bool isLeftDown, bool isRightDown) noexcept;
+	void setKeyState(graphics::scancode_t key, bool isPressed) noexcept;
+
+	void setRecording(bool isRecording) noexcept;
+	const std::vector<DrawCall>& getDrawCalls(void) const noexcept;
+	const DrawStats& getTotalStats(void) const noexcept;
+
+	uint64_t getFrameCount(void) const noexcept;
+	double getTime(void) const noexcept;
+
+private:
+	void runFrame(void);
+
+private:
+	UpdateFunction m_update;
+	DrawFunction m_draw;
+	ScriptFunction m_script;
+
+	float m_frameTime;
+	uint64_t m_frameCount = 0;
+
+	/// <summary>
+	/// Simulated milliseconds since the message loop started
+	/// </summary>
+	double m_time = 0.0;
+
+	/// <summary>
+	/// The state of the mouse during the current frame. The pressed/released flags
+	/// are calculated at the start of each frame from the previous state.
+	/// </summary>
+	graphics::MouseState m_mouseState = {};
+	bool m_isLeftDown = false;
+	bool m_isRightDown = false;
+	int m_mouseX = 0;
+	int m_mouseY = 0;
+
+	bool m_keyStates[HEADLESS_KEY_COUNT] = {};
+
+	/// <summary>
+	/// The draw calls of the last frame. Only filled if recording is enabled,
+	/// the totals are always counted.
+	/// </summary>
+	std::vector<DrawCall> m_drawCalls;
+	bool m_isRecording = true;
+	DrawStats m_totalStats;
+};
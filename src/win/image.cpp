@@ -0,0 +1,1224 @@
+#include "image.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+/// <summary>
+/// Images with more pixels than that are refused, instead of allocating gigabytes because of a damaged header.
+/// </summary>
+#define IMAGE_MAX_PIXELS (1U << 26)
+
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_HASH_BITS 15
+
+/// <summary>
+/// How many earlier occurrences of the same three bytes are tried when looking for a match.
+/// </summary>
+#define DEFLATE_MAX_CHAIN 64
+
+/// <summary>
+/// Weights of the box filter are fractions of BOX_WEIGHT_ONE. Between the two passes the values keep
+/// BOX_FRACTION_BITS bits below the point, so that they still fit in 16 bits and the vertical pass in 32.
+/// </summary>
+#define BOX_WEIGHT_BITS 14
+#define BOX_WEIGHT_ONE (1U << BOX_WEIGHT_BITS)
+#define BOX_FRACTION_BITS 8
+
+static const uint8_t g_pngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+static const uint16_t g_lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t g_lengthExtraBits[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t g_distanceBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+	1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t g_distanceExtraBits[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/// <summary>
+/// The order that the lengths of the code length code are stored in by a dynamic deflate block
+/// </summary>
+static const uint8_t g_codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static uint32_t readU32(const uint8_t* pData) noexcept
+{
+	return (static_cast<uint32_t>(pData[0]) << 24) | (pData[1] << 16) | (pData[2] << 8) | pData[3];
+}
+
+static void appendU32(std::vector<uint8_t>& data, uint32_t value)
+{
+	data.push_back(static_cast<uint8_t>(value >> 24));
+	data.push_back(static_cast<uint8_t>(value >> 16));
+	data.push_back(static_cast<uint8_t>(value >> 8));
+	data.push_back(static_cast<uint8_t>(value));
+}
+
+static std::array<uint32_t, 256> makeCrcTable(void) noexcept
+{
+	std::array<uint32_t, 256> table;
+
+	for (uint32_t n = 0; n < 256; ++n)
+	{
+		uint32_t value = n;
+
+		for (int bit = 0; bit < 8; ++bit)
+		{
+			value = (value & 1) ? (0xEDB88320U ^ (value >> 1)) : (value >> 1);
+		}
+
+		table[n] = value;
+	}
+
+	return table;
+}
+
+/// <summary>
+/// The CRC-32 that every PNG chunk ends with.
+/// </summary>
+static uint32_t computeCrc(const uint8_t* pData, size_t size) noexcept
+{
+	static const std::array<uint32_t, 256> table = makeCrcTable();
+
+	uint32_t crc = 0xFFFFFFFFU;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc ^ 0xFFFFFFFFU;
+}
+
+/// <summary>
+/// The Adler-32 checksum that a zlib stream ends with.
+/// </summary>
+static uint32_t computeAdler(const uint8_t* pData, size_t size) noexcept
+{
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	while (size > 0)
+	{
+		// The sums can't overflow for this many bytes before they are reduced
+		const size_t count = std::min<size_t>(size, 5552);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			a += pData[i];
+			b += a;
+		}
+
+		a %= 65521;
+		b %= 65521;
+		pData += count;
+		size -= count;
+	}
+
+	return (b << 16) | a;
+}
+
+static uint32_t reverseBits(uint32_t code, int length) noexcept
+{
+	uint32_t reversed = 0;
+
+	for (int i = 0; i < length; ++i)
+	{
+		reversed = (reversed << 1) | ((code >> i) & 1);
+	}
+
+	return reversed;
+}
+
+/// <summary>
+/// Reads the bits of a deflate stream, least significant first. Past the end of the data it reads zeros,
+/// so that the decoder doesn't have to check every read, and reports it with isOverrun instead.
+/// </summary>
+class BitReader
+{
+public:
+	BitReader(const uint8_t* pData, size_t size)
+		: m_pData(pData), m_size(size) {}
+
+	uint32_t peek(int count) noexcept
+	{
+		while (m_bitCount < count)
+		{
+			const uint8_t byte = (m_position < m_size) ? m_pData[m_position] : 0;
+
+			if (m_position >= m_size)
+			{
+				++m_paddingBytes;
+			}
+
+			m_buffer |= static_cast<uint64_t>(byte) << m_bitCount;
+			m_bitCount += 8;
+			++m_position;
+		}
+
+		return static_cast<uint32_t>(m_buffer & ((1ULL << count) - 1));
+	}
+
+	void skip(int count) noexcept
+	{
+		m_buffer >>= count;
+		m_bitCount -= count;
+	}
+
+	uint32_t read(int count) noexcept
+	{
+		const uint32_t value = peek(count);
+		skip(count);
+		return value;
+	}
+
+	void alignToByte(void) noexcept
+	{
+		skip(m_bitCount % 8);
+	}
+
+	/// <summary>
+	/// Returns whether any of the zeros read past the end of the data have been used.
+	/// </summary>
+	bool isOverrun(void) const noexcept
+	{
+		return m_paddingBytes * 8 > static_cast<size_t>(m_bitCount);
+	}
+
+private:
+	const uint8_t* m_pData;
+	size_t m_size;
+	size_t m_position = 0;
+	size_t m_paddingBytes = 0;
+
+	uint64_t m_buffer = 0;
+	int m_bitCount = 0;
+};
+
+/// <summary>
+/// A canonical Huffman code of a deflate block, decoded with a single lookup. The table is indexed by
+/// the next maxLength bits of the stream, and each entry holds the symbol above the length of its code.
+/// An entry of 0 means that no code starts with those bits.
+/// </summary>
+struct HuffmanTable
+{
+	std::vector<uint16_t> entries;
+	int maxLength = 0;
+
+	bool build(const uint8_t* pLengths, int count);
+};
+
+bool HuffmanTable::build(const uint8_t* pLengths, int count)
+{
+	int lengthCounts[16] = {};
+	maxLength = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		++lengthCounts[pLengths[i]];
+		maxLength = std::max<int>(maxLength, pLengths[i]);
+	}
+
+	lengthCounts[0] = 0;
+
+	int nextCode[16] = {};
+	int code = 0;
+
+	for (int length = 1; length < 16; ++length)
+	{
+		code = (code + lengthCounts[length - 1]) << 1;
+		nextCode[length] = code;
+	}
+
+	entries.assign(static_cast<size_t>(1) << maxLength, 0);
+
+	for (int symbol = 0; symbol < count; ++symbol)
+	{
+		const int length = pLengths[symbol];
+
+		if (length == 0)
+		{
+			continue;
+		}
+
+		// More codes of this length than there is room for
+		if (nextCode[length] >= (1 << length))
+		{
+			return false;
+		}
+
+		const uint32_t reversed = reverseBits(nextCode[length]++, length);
+
+		for (size_t i = reversed; i < entries.size(); i += static_cast<size_t>(1) << length)
+		{
+			entries[i] = static_cast<uint16_t>((symbol << 4) | length);
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Returns the next symbol of the stream, or -1 if its bits aren't a code of the table.
+/// </summary>
+static int decodeSymbol(BitReader& reader, const HuffmanTable& table) noexcept
+{
+	const uint16_t entry = table.entries[reader.peek(table.maxLength)];
+	const int length = entry & 15;
+
+	if (length == 0)
+	{
+		return -1;
+	}
+
+	reader.skip(length);
+	return entry >> 4;
+}
+
+static bool readDynamicTables(BitReader& reader, HuffmanTable& literals, HuffmanTable& distances)
+{
+	const int literalCount = static_cast<int>(reader.read(5)) + 257;
+	const int distanceCount = static_cast<int>(reader.read(5)) + 1;
+	const int codeLengthCount = static_cast<int>(reader.read(4)) + 4;
+
+	uint8_t codeLengthLengths[19] = {};
+
+	for (int i = 0; i < codeLengthCount; ++i)
+	{
+		codeLengthLengths[g_codeLengthOrder[i]] = static_cast<uint8_t>(reader.read(3));
+	}
+
+	HuffmanTable codeLengths;
+
+	if (!codeLengths.build(codeLengthLengths, 19))
+	{
+		return false;
+	}
+
+	uint8_t lengths[320] = {};
+	const int total = literalCount + distanceCount;
+
+	for (int i = 0; i < total; )
+	{
+		const int symbol = decodeSymbol(reader, codeLengths);
+
+		if (symbol < 0)
+		{
+			return false;
+		}
+
+		if (symbol < 16)
+		{
+			lengths[i++] = static_cast<uint8_t>(symbol);
+			continue;
+		}
+
+		uint8_t value = 0;
+		int repeat = 0;
+
+		if (symbol == 16)
+		{
+			if (i == 0)
+			{
+				return false;
+			}
+
+			value = lengths[i - 1];
+			repeat = 3 + static_cast<int>(reader.read(2));
+		}
+		else if (symbol == 17)
+		{
+			repeat = 3 + static_cast<int>(reader.read(3));
+		}
+		else
+		{
+			repeat = 11 + static_cast<int>(reader.read(7));
+		}
+
+		if (i + repeat > total)
+		{
+			return false;
+		}
+
+		std::fill(lengths + i, lengths + i + repeat, value);
+		i += repeat;
+	}
+
+	// A block without an end of block code could never end
+	if (lengths[256] == 0)
+	{
+		return false;
+	}
+
+	return literals.build(lengths, literalCount) && distances.build(lengths + literalCount, distanceCount);
+}
+
+static void buildFixedTables(HuffmanTable& literals, HuffmanTable& distances)
+{
+	uint8_t lengths[288];
+
+	std::fill(lengths, lengths + 144, 8);
+	std::fill(lengths + 144, lengths + 256, 9);
+	std::fill(lengths + 256, lengths + 280, 7);
+	std::fill(lengths + 280, lengths + 288, 8);
+	literals.build(lengths, 288);
+
+	std::fill(lengths, lengths + 30, 5);
+	distances.build(lengths, 30);
+}
+
+static bool inflateBlock(BitReader& reader, const HuffmanTable& literals, const HuffmanTable& distances, std::vector<uint8_t>& output, size_t maxSize)
+{
+	while (!reader.isOverrun())
+	{
+		int symbol = decodeSymbol(reader, literals);
+
+		if (symbol < 0)
+		{
+			return false;
+		}
+
+		if (symbol < 256)
+		{
+			output.push_back(static_cast<uint8_t>(symbol));
+		}
+		else if (symbol == 256)
+		{
+			return true;
+		}
+		else
+		{
+			symbol -= 257;
+
+			if (symbol >= 29)
+			{
+				return false;
+			}
+
+			const size_t length = g_lengthBase[symbol] + reader.read(g_lengthExtraBits[symbol]);
+			const int distanceSymbol = decodeSymbol(reader, distances);
+
+			if (distanceSymbol < 0 || distanceSymbol >= 30)
+			{
+				return false;
+			}
+
+			const size_t distance = g_distanceBase[distanceSymbol] + reader.read(g_distanceExtraBits[distanceSymbol]);
+
+			if (distance > output.size())
+			{
+				return false;
+			}
+
+			// The match may overlap the bytes it produces, so it is copied one byte at a time
+			const size_t from = output.size() - distance;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				output.push_back(output[from + i]);
+			}
+		}
+
+		if (output.size() > maxSize)
+		{
+			return false;
+		}
+	}
+
+	return false;
+}
+
+/// <summary>
+/// Decompresses a zlib stream. The checksum at the end isn't verified, since the PNG chunks already have one.
+/// </summary>
+/// <param name="maxSize">How many bytes the stream may produce at most</param>
+static bool inflate(const uint8_t* pData, size_t size, std::vector<uint8_t>& output, size_t maxSize)
+{
+	// Deflate compression, and no preset dictionary
+	if (size < 2 || (pData[0] & 0x0F) != 8 || ((pData[0] << 8) | pData[1]) % 31 != 0 || (pData[1] & 0x20))
+	{
+		return false;
+	}
+
+	BitReader reader(pData + 2, size - 2);
+	HuffmanTable literals;
+	HuffmanTable distances;
+	bool isLastBlock = false;
+
+	output.clear();
+	output.reserve(maxSize);
+
+	while (!isLastBlock)
+	{
+		isLastBlock = reader.read(1) != 0;
+		const uint32_t type = reader.read(2);
+
+		if (type == 0)
+		{
+			reader.alignToByte();
+
+			const uint32_t length = reader.read(16);
+
+			if ((reader.read(16) ^ 0xFFFF) != length || output.size() + length > maxSize)
+			{
+				return false;
+			}
+
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				output.push_back(static_cast<uint8_t>(reader.read(8)));
+			}
+		}
+		else
+		{
+			if (type == 1)
+			{
+				buildFixedTables(literals, distances);
+			}
+			else if (type != 2 || !readDynamicTables(reader, literals, distances))
+			{
+				return false;
+			}
+
+			if (!inflateBlock(reader, literals, distances, output, maxSize))
+			{
+				return false;
+			}
+		}
+
+		if (reader.isOverrun())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Writes the bits of a deflate stream, least significant first.
+/// </summary>
+class BitWriter
+{
+public:
+	explicit BitWriter(std::vector<uint8_t>& output)
+		: m_output(output) {}
+
+	void write(uint32_t value, int count)
+	{
+		m_buffer |= static_cast<uint64_t>(value) << m_bitCount;
+		m_bitCount += count;
+
+		while (m_bitCount >= 8)
+		{
+			m_output.push_back(static_cast<uint8_t>(m_buffer));
+			m_buffer >>= 8;
+			m_bitCount -= 8;
+		}
+	}
+
+	/// <summary>
+	/// Huffman codes are stored starting from their most significant bit.
+	/// </summary>
+	void writeCode(uint32_t code, int length)
+	{
+		write(reverseBits(code, length), length);
+	}
+
+	void flush(void)
+	{
+		if (m_bitCount > 0)
+		{
+			m_output.push_back(static_cast<uint8_t>(m_buffer));
+		}
+
+		m_buffer = 0;
+		m_bitCount = 0;
+	}
+
+private:
+	std::vector<uint8_t>& m_output;
+	uint64_t m_buffer = 0;
+	int m_bitCount = 0;
+};
+
+/// <summary>
+/// Writes a literal/length symbol with the fixed Huffman code of deflate.
+/// </summary>
+static void writeFixedSymbol(BitWriter& writer, int symbol)
+{
+	if (symbol < 144)
+	{
+		writer.writeCode(0x30 + symbol, 8);
+	}
+	else if (symbol < 256)
+	{
+		writer.writeCode(0x190 + symbol - 144, 9);
+	}
+	else if (symbol < 280)
+	{
+		writer.writeCode(symbol - 256, 7);
+	}
+	else
+	{
+		writer.writeCode(0xC0 + symbol - 280, 8);
+	}
+}
+
+static void writeMatch(BitWriter& writer, size_t length, size_t distance)
+{
+	int lengthCode = 28;
+
+	while (g_lengthBase[lengthCode] > length)
+	{
+		--lengthCode;
+	}
+
+	writeFixedSymbol(writer, 257 + lengthCode);
+	writer.write(static_cast<uint32_t>(length - g_lengthBase[lengthCode]), g_lengthExtraBits[lengthCode]);
+
+	int distanceCode = 29;
+
+	while (g_distanceBase[distanceCode] > distance)
+	{
+		--distanceCode;
+	}
+
+	writer.writeCode(distanceCode, 5);
+	writer.write(static_cast<uint32_t>(distance - g_distanceBase[distanceCode]), g_distanceExtraBits[distanceCode]);
+}
+
+static uint32_t hashBytes(const uint8_t* pData) noexcept
+{
+	return ((pData[0] << 10) ^ (pData[1] << 5) ^ pData[2]) & ((1U << DEFLATE_HASH_BITS) - 1);
+}
+
+/// <summary>
+/// Compresses data into a zlib stream of a single fixed Huffman block. Matches are found greedily
+/// with hash chains over the last DEFLATE_WINDOW_SIZE bytes.
+/// </summary>
+static void deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>& output)
+{
+	output.push_back(0x78);
+	output.push_back(0x9C);
+
+	BitWriter writer(output);
+	writer.write(1, 1);
+	writer.write(1, 2);
+
+	std::vector<int32_t> head(static_cast<size_t>(1) << DEFLATE_HASH_BITS, -1);
+	std::vector<int32_t> previous(DEFLATE_WINDOW_SIZE, -1);
+
+	const size_t size = data.size();
+
+	auto insert = [&](size_t position) {
+		if (position + DEFLATE_MIN_MATCH <= size)
+		{
+			const uint32_t hash = hashBytes(&data[position]);
+			previous[position % DEFLATE_WINDOW_SIZE] = head[hash];
+			head[hash] = static_cast<int32_t>(position);
+		}
+	};
+
+	for (size_t i = 0; i < size; )
+	{
+		size_t bestLength = 0;
+		size_t bestDistance = 0;
+
+		if (i + DEFLATE_MIN_MATCH <= size)
+		{
+			const size_t maxLength = std::min<size_t>(DEFLATE_MAX_MATCH, size - i);
+			int32_t candidate = head[hashBytes(&data[i])];
+
+			for (int chain = 0; chain < DEFLATE_MAX_CHAIN && candidate >= 0 && i - candidate <= DEFLATE_WINDOW_SIZE; ++chain)
+			{
+				size_t length = 0;
+
+				while (length < maxLength && data[candidate + length] == data[i + length])
+				{
+					++length;
+				}
+
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestDistance = i - candidate;
+
+					if (length == maxLength)
+					{
+						break;
+					}
+				}
+
+				// The slot may have been reused by a newer position, which would send the chain forward
+				const int32_t next = previous[candidate % DEFLATE_WINDOW_SIZE];
+
+				if (next >= candidate)
+				{
+					break;
+				}
+
+				candidate = next;
+			}
+		}
+
+		if (bestLength >= DEFLATE_MIN_MATCH)
+		{
+			writeMatch(writer, bestLength, bestDistance);
+
+			for (size_t j = 0; j < bestLength; ++j)
+			{
+				insert(i + j);
+			}
+
+			i += bestLength;
+		}
+		else
+		{
+			writeFixedSymbol(writer, data[i]);
+			insert(i);
+			++i;
+		}
+	}
+
+	writeFixedSymbol(writer, 256);
+	writer.flush();
+
+	appendU32(output, computeAdler(data.data(), data.size()));
+}
+
+static uint8_t paethPredictor(int a, int b, int c) noexcept
+{
+	const int p = a + b - c;
+	const int pa = std::abs(p - a);
+	const int pb = std::abs(p - b);
+	const int pc = std::abs(p - c);
+
+	if (pa <= pb && pa <= pc)
+	{
+		return static_cast<uint8_t>(a);
+	}
+
+	return static_cast<uint8_t>((pb <= pc) ? b : c);
+}
+
+/// <summary>
+/// Undoes the filter of a scanline in place.
+/// </summary>
+/// <param name="pRow">The filtered bytes of the scanline, without the filter type</param>
+/// <param name="pPrior">The scanline above, already unfiltered, or zeros for the first one</param>
+/// <param name="bytesPerPixel">Distance to the byte of the pixel on the left, at least 1</param>
+static bool unfilterRow(uint8_t filter, uint8_t* pRow, const uint8_t* pPrior, size_t rowBytes, size_t bytesPerPixel)
+{
+	switch (filter)
+	{
+	case 0:
+		return true;
+
+	case 1:
+		for (size_t i = bytesPerPixel; i < rowBytes; ++i)
+		{
+			pRow[i] += pRow[i - bytesPerPixel];
+		}
+		return true;
+
+	case 2:
+		for (size_t i = 0; i < rowBytes; ++i)
+		{
+			pRow[i] += pPrior[i];
+		}
+		return true;
+
+	case 3:
+		for (size_t i = 0; i < rowBytes; ++i)
+		{
+			const int left = (i >= bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+			pRow[i] += static_cast<uint8_t>((left + pPrior[i]) / 2);
+		}
+		return true;
+
+	case 4:
+		for (size_t i = 0; i < rowBytes; ++i)
+		{
+			const int left = (i >= bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+			const int upperLeft = (i >= bytesPerPixel) ? pPrior[i - bytesPerPixel] : 0;
+			pRow[i] += paethPredictor(left, pPrior[i], upperLeft);
+		}
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// Filters a scanline with the given filter type, the opposite of unfilterRow.
+/// </summary>
+static void filterRow(uint8_t filter, const uint8_t* pRow, const uint8_t* pPrior, size_t rowBytes, size_t bytesPerPixel, uint8_t* pOutput)
+{
+	for (size_t i = 0; i < rowBytes; ++i)
+	{
+		const int left = (i >= bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+		const int upperLeft = (i >= bytesPerPixel) ? pPrior[i - bytesPerPixel] : 0;
+		int predicted = 0;
+
+		switch (filter)
+		{
+		case 1: predicted = left; break;
+		case 2: predicted = pPrior[i]; break;
+		case 3: predicted = (left + pPrior[i]) / 2; break;
+		case 4: predicted = paethPredictor(left, pPrior[i], upperLeft); break;
+		default: break;
+		}
+
+		pOutput[i] = static_cast<uint8_t>(pRow[i] - predicted);
+	}
+}
+
+static void appendChunk(std::vector<uint8_t>& file, const char* type, const std::vector<uint8_t>& data)
+{
+	appendU32(file, static_cast<uint32_t>(data.size()));
+
+	const size_t start = file.size();
+	file.insert(file.end(), type, type + 4);
+	file.insert(file.end(), data.begin(), data.end());
+
+	appendU32(file, computeCrc(&file[start], file.size() - start));
+}
+
+Image::Image(uint32_t width, uint32_t height)
+	: m_width(width), m_height(height), m_pixels(static_cast<size_t>(width) * height * 4)
+{
+}
+
+/// <summary>
+/// Reads a PNG file of any color type, at any bit depth. 16-bit channels are cut to 8 bits,
+/// and a transparent color given by a tRNS chunk is only honoured for palette images.
+/// </summary>
+/// <param name="path">Path to the file</param>
+/// <returns>False if the file couldn't be read, is damaged or is interlaced</returns>
+bool Image::loadPng(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (data.size() < sizeof(g_pngSignature) || memcmp(data.data(), g_pngSignature, sizeof(g_pngSignature)) != 0)
+	{
+		return false;
+	}
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint8_t bitDepth = 0;
+	uint8_t colorType = 0;
+	uint8_t palette[256][4] = {};
+	std::vector<uint8_t> compressed;
+
+	for (size_t position = sizeof(g_pngSignature); ; )
+	{
+		if (position + 12 > data.size())
+		{
+			return false;
+		}
+
+		const uint32_t length = readU32(&data[position]);
+		const uint8_t* pType = &data[position + 4];
+		const uint8_t* pChunk = &data[position + 8];
+
+		if (length > data.size() - position - 12)
+		{
+			return false;
+		}
+
+		if (memcmp(pType, "IHDR", 4) == 0)
+		{
+			if (length != 13)
+			{
+				return false;
+			}
+
+			width = readU32(pChunk);
+			height = readU32(pChunk + 4);
+			bitDepth = pChunk[8];
+			colorType = pChunk[9];
+
+			// Only deflate compression and the adaptive filters exist, and interlacing isn't supported
+			if (pChunk[10] != 0 || pChunk[11] != 0 || pChunk[12] != 0)
+			{
+				return false;
+			}
+		}
+		else if (memcmp(pType, "PLTE", 4) == 0)
+		{
+			for (uint32_t i = 0; i < length / 3 && i < 256; ++i)
+			{
+				palette[i][0] = pChunk[i * 3];
+				palette[i][1] = pChunk[i * 3 + 1];
+				palette[i][2] = pChunk[i * 3 + 2];
+				palette[i][3] = 255;
+			}
+		}
+		else if (memcmp(pType, "tRNS", 4) == 0 && colorType == 3)
+		{
+			for (uint32_t i = 0; i < length && i < 256; ++i)
+			{
+				palette[i][3] = pChunk[i];
+			}
+		}
+		else if (memcmp(pType, "IDAT", 4) == 0)
+		{
+			compressed.insert(compressed.end(), pChunk, pChunk + length);
+		}
+		else if (memcmp(pType, "IEND", 4) == 0)
+		{
+			break;
+		}
+
+		position += 12 + static_cast<size_t>(length);
+	}
+
+	int channels = 0;
+
+	switch (colorType)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+
+	const bool isValidDepth = (bitDepth == 8) || (bitDepth == 16 && colorType != 3) ||
+		((bitDepth == 1 || bitDepth == 2 || bitDepth == 4) && (colorType == 0 || colorType == 3));
+
+	if (!isValidDepth || width == 0 || height == 0 || static_cast<uint64_t>(width) * height > IMAGE_MAX_PIXELS)
+	{
+		return false;
+	}
+
+	const size_t bitsPerPixel = static_cast<size_t>(channels) * bitDepth;
+	const size_t bytesPerPixel = std::max<size_t>(1, bitsPerPixel / 8);
+	const size_t rowBytes = (width * bitsPerPixel + 7) / 8;
+	const size_t stride = rowBytes + 1;
+
+	std::vector<uint8_t> raw;
+
+	if (!inflate(compressed.data(), compressed.size(), raw, stride * height) || raw.size() != stride * height)
+	{
+		return false;
+	}
+
+	const std::vector<uint8_t> zeros(rowBytes, 0);
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		uint8_t* pRow = &raw[y * stride + 1];
+		const uint8_t* pPrior = (y > 0) ? pRow - stride : zeros.data();
+
+		if (!unfilterRow(pRow[-1], pRow, pPrior, rowBytes, bytesPerPixel))
+		{
+			return false;
+		}
+	}
+
+	m_width = width;
+	m_height = height;
+	m_pixels.resize(static_cast<size_t>(width) * height * 4);
+
+	const int maxSample = (1 << bitDepth) - 1;
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint8_t* pRow = &raw[y * stride + 1];
+		uint8_t* pPixel = &m_pixels[static_cast<size_t>(y) * width * 4];
+
+		for (uint32_t x = 0; x < width; ++x, pPixel += 4)
+		{
+			uint8_t samples[4] = { 0, 0, 0, 255 };
+
+			if (bitDepth < 8)
+			{
+				const size_t bit = static_cast<size_t>(x) * bitDepth;
+				samples[0] = static_cast<uint8_t>((pRow[bit / 8] >> (8 - bitDepth - bit % 8)) & maxSample);
+			}
+			else
+			{
+				// The most significant byte comes first in 16-bit samples
+				for (int c = 0; c < channels; ++c)
+				{
+					samples[c] = pRow[(static_cast<size_t>(x) * channels + c) * (bitDepth / 8)];
+				}
+			}
+
+			switch (colorType)
+			{
+			case 0:
+				pPixel[0] = pPixel[1] = pPixel[2] = static_cast<uint8_t>((bitDepth < 8) ? samples[0] * 255 / maxSample : samples[0]);
+				pPixel[3] = 255;
+				break;
+
+			case 2:
+			case 6:
+				memcpy(pPixel, samples, 4);
+				break;
+
+			case 3:
+				memcpy(pPixel, palette[samples[0]], 4);
+				break;
+
+			case 4:
+				pPixel[0] = pPixel[1] = pPixel[2] = samples[0];
+				pPixel[3] = samples[1];
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Writes the image as an 8-bit PNG file, without the alpha channel if every pixel is opaque.
+/// Each scanline uses the filter that leaves the smallest differences, which usually compresses best.
+/// </summary>
+/// <param name="path">Path to the file, which is replaced if it exists</param>
+/// <returns>False if the file couldn't be written, in which case nothing is left behind</returns>
+bool Image::savePng(const std::string& path) const
+{
+	bool isOpaque = true;
+
+	for (size_t i = 3; i < m_pixels.size() && isOpaque; i += 4)
+	{
+		isOpaque = m_pixels[i] == 255;
+	}
+
+	const size_t channels = isOpaque ? 3 : 4;
+	const size_t rowBytes = m_width * channels;
+
+	std::vector<uint8_t> raw;
+	raw.reserve((rowBytes + 1) * m_height);
+
+	std::vector<uint8_t> row(rowBytes);
+	std::vector<uint8_t> prior(rowBytes, 0);
+	std::vector<uint8_t> filtered(rowBytes);
+	std::vector<uint8_t> bestFiltered(rowBytes);
+
+	for (uint32_t y = 0; y < m_height; ++y)
+	{
+		const uint8_t* pPixel = &m_pixels[static_cast<size_t>(y) * m_width * 4];
+
+		for (uint32_t x = 0; x < m_width; ++x, pPixel += 4)
+		{
+			memcpy(&row[x * channels], pPixel, channels);
+		}
+
+		uint8_t bestFilter = 0;
+		uint64_t bestScore = UINT64_MAX;
+
+		for (uint8_t filter = 0; filter < 5; ++filter)
+		{
+			filterRow(filter, row.data(), prior.data(), rowBytes, channels, filtered.data());
+
+			uint64_t score = 0;
+
+			for (uint8_t value : filtered)
+			{
+				score += std::abs(static_cast<int8_t>(value));
+			}
+
+			if (score < bestScore)
+			{
+				bestScore = score;
+				bestFilter = filter;
+				bestFiltered.swap(filtered);
+			}
+		}
+
+		raw.push_back(bestFilter);
+		raw.insert(raw.end(), bestFiltered.begin(), bestFiltered.end());
+		prior.swap(row);
+	}
+
+	std::vector<uint8_t> header;
+	appendU32(header, m_width);
+	appendU32(header, m_height);
+	header.push_back(8);
+	header.push_back(isOpaque ? 2 : 6);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+
+	std::vector<uint8_t> compressed;
+	deflate(raw, compressed);
+
+	std::vector<uint8_t> file(g_pngSignature, g_pngSignature + sizeof(g_pngSignature));
+	appendChunk(file, "IHDR", header);
+	appendChunk(file, "IDAT", compressed);
+	appendChunk(file, "IEND", std::vector<uint8_t>());
+
+	std::ofstream output(path, std::ios::binary | std::ios::trunc);
+	output.write(reinterpret_cast<const char*>(file.data()), file.size());
+	output.close();
+
+	if (!output)
+	{
+		std::remove(path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// The weights that a box filter uses along one axis. Destination pixel i is the average of the source pixels
+/// first[i] to first[i] + count[i] - 1, each weighted by how much of it the destination pixel covers.
+/// The weights of a destination pixel start at offset[i] and add up to BOX_WEIGHT_ONE.
+/// </summary>
+struct BoxWeights
+{
+	std::vector<uint32_t> first;
+	std::vector<uint32_t> count;
+	std::vector<uint32_t> offset;
+	std::vector<uint32_t> weights;
+
+	BoxWeights(uint32_t sourceSize, uint32_t destinationSize);
+};
+
+BoxWeights::BoxWeights(uint32_t sourceSize, uint32_t destinationSize)
+{
+	// Positions are measured in units of 1 / (sourceSize * destinationSize), so that both the
+	// source and the destination pixels start and end on whole units
+	for (uint32_t i = 0; i < destinationSize; ++i)
+	{
+		const uint64_t start = static_cast<uint64_t>(i) * sourceSize;
+		const uint64_t end = start + sourceSize;
+		const uint32_t firstPixel = static_cast<uint32_t>(start / destinationSize);
+		const uint32_t lastPixel = static_cast<uint32_t>((end - 1) / destinationSize);
+
+		first.push_back(firstPixel);
+		count.push_back(lastPixel - firstPixel + 1);
+		offset.push_back(static_cast<uint32_t>(weights.size()));
+
+		uint32_t total = 0;
+		size_t largest = weights.size();
+
+		for (uint32_t pixel = firstPixel; pixel <= lastPixel; ++pixel)
+		{
+			const uint64_t covered = std::min(end, static_cast<uint64_t>(pixel + 1) * destinationSize) -
+				std::max(start, static_cast<uint64_t>(pixel) * destinationSize);
+			const uint32_t weight = static_cast<uint32_t>(covered * BOX_WEIGHT_ONE / sourceSize);
+
+			if (weights.size() == largest || weight > weights[largest])
+			{
+				largest = weights.size();
+			}
+
+			weights.push_back(weight);
+			total += weight;
+		}
+
+		// Rounding down loses a little, which goes to the pixel that counts the most
+		weights[largest] += BOX_WEIGHT_ONE - total;
+	}
+}
+
+/// <summary>
+/// Shrinks the image with a box filter, so every destination pixel is the average of the source pixels it covers.
+/// The filter is separable: every source row is first shrunk horizontally, then the rows are blended
+/// together. Both passes use integer weights, and the vertical one, which does most of the work, runs over
+/// whole rows at a time so that the compiler can vectorize it.
+/// </summary>
+/// <param name="width">Width of the result, no bigger than the width of the image</param>
+/// <param name="height">Height of the result, no bigger than the height of the image</param>
+Image Image::downscale(uint32_t width, uint32_t height) const
+{
+	width = std::max<uint32_t>(1, std::min(width, m_width));
+	height = std::max<uint32_t>(1, std::min(height, m_height));
+
+	Image result(width, height);
+
+	if (m_pixels.empty())
+	{
+		return result;
+	}
+
+	const BoxWeights columns(m_width, width);
+	const BoxWeights rows(m_height, height);
+	const size_t rowValues = static_cast<size_t>(width) * 4;
+
+	std::vector<uint16_t> horizontal(rowValues * m_height);
+
+	for (uint32_t y = 0; y < m_height; ++y)
+	{
+		const uint8_t* pSource = &m_pixels[static_cast<size_t>(y) * m_width * 4];
+		uint16_t* pDestination = &horizontal[y * rowValues];
+
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint32_t sum[4] = {};
+			const uint8_t* pPixel = pSource + static_cast<size_t>(columns.first[x]) * 4;
+			const uint32_t* pWeight = &columns.weights[columns.offset[x]];
+
+			for (uint32_t k = 0; k < columns.count[x]; ++k, pPixel += 4)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					sum[c] += pWeight[k] * pPixel[c];
+				}
+			}
+
+			for (int c = 0; c < 4; ++c)
+			{
+				pDestination[x * 4 + c] = static_cast<uint16_t>((sum[c] + (1U << (BOX_WEIGHT_BITS - BOX_FRACTION_BITS - 1))) >> (BOX_WEIGHT_BITS - BOX_FRACTION_BITS));
+			}
+		}
+	}
+
+	std::vector<uint32_t> accumulator(rowValues);
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		std::fill(accumulator.begin(), accumulator.end(), 0);
+
+		for (uint32_t k = 0; k < rows.count[y]; ++k)
+		{
+			const uint32_t weight = rows.weights[rows.offset[y] + k];
+			const uint16_t* pRow = &horizontal[(rows.first[y] + k) * rowValues];
+
+			for (size_t i = 0; i < rowValues; ++i)
+			{
+				accumulator[i] += weight * pRow[i];
+			}
+		}
+
+		uint8_t* pDestination = &result.m_pixels[y * rowValues];
+
+		for (size_t i = 0; i < rowValues; ++i)
+		{
+			pDestination[i] = static_cast<uint8_t>((accumulator[i] + (1U << (BOX_WEIGHT_BITS + BOX_FRACTION_BITS - 1))) >> (BOX_WEIGHT_BITS + BOX_FRACTION_BITS));
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// An 8-bit RGBA image in memory, stored row by row from the top. sgg draws PNG files but doesn't give
+/// access to their pixels, so this reads and writes PNG files itself. It is used to generate the
+/// pre-scaled thumbnails the first time the app runs, so it favours being small over being complete:
+/// interlaced images can't be loaded, and images are always saved with the fixed deflate code.
+/// </summary>
+class Image
+{
+public:
+	Image(void) = default;
+	Image(uint32_t width, uint32_t height);
+
+	bool loadPng(const std::string& path);
+	bool savePng(const std::string& path) const;
+
+	Image downscale(uint32_t width, uint32_t height) const;
+
+	inline uint32_t getWidth(void) const noexcept
+	{
+		return m_width;
+	}
+
+	inline uint32_t getHeight(void) const noexcept
+	{
+		return m_height;
+	}
+
+private:
+	uint32_t m_width = 0;
+	uint32_t m_height = 0;
+
+	/// <summary>
+	/// Four bytes per pixel, in R, G, B, A order
+	/// </summary>
+	std::vector<uint8_t> m_pixels;
+};
@@ -1,33 +1,97 @@
 #pragma once
 
+#include <sgg/scancodes.h>
+
+#include "types.h"
+
 // Step 1: MessageGenerator::generateMessages is called during the update function of the sgg window.
-//         This method may allocate some data on the heap so we must deallocate the data later.
+//         The payload of each message is stored inside the message itself, so this doesn't allocate.
 //
-// Step 2: Each message generated is added to the message queue of the top level window using postMessage
+// Step 2: Each message generated is posted to the top level window using postMessage, which adds it
+//         to the event queue that is shared by every Widget
 //
-// Step 3: The update function of the top level window is called, which removes the oldest message from
-//         from the queue and forwards it to the appropriate window using Messenger::forwardMessage
+// Step 3: The update function of the top level window is called, which removes the messages from the
+//         queue, input first, and dispatches them to the appropriate Widget using Messenger::dispatchMessage.
+//         Messages that aren't input may be left in the queue for the next frame if there is no time left.
 //
-// Step 4: MessageGenerator::deallocateMessage is called in order to potentially deallocate memory
+// Step 4: MessageGenerator::endFrame is called, which copies the CustomMessageInfo of the CUSTOM
+//         messages that are still queued into the arena of the next frame and switches arenas, so the
+//         CustomMessageInfo of the messages posted during a frame is released at the end of the next one
+
+class Widget;
+
+struct KeyMessageInfo
+{
+	graphics::scancode_t scancode;
+	char key;
+
+	bool isShiftPressed;
+	bool isCtrlPressed;
+
+	/// <summary>
+	/// True if the message was generated because the key is being held down, not because it was just pressed
+	/// </summary>
+	bool isRepeat;
+};
+
+struct MouseMessageInfo
+{
+	bool isLeftPressed;
+	bool isRightPressed;
+	bool isMiddlePressed;
+};
+
+struct CustomMessageInfo
+{
+	int id;
+	void* data;
+};
+
+struct TimerMessageInfo
+{
+	Widget* pRecipient;
+	int timer_id;
+
+	/// <summary>
+	/// Handle of the timer that generated the message, used to drop the message if the timer is killed while it is queued
+	/// </summary>
+	TimerHandle handle;
+
+	/// <summary>
+	/// How many times the timer has elapsed since the last message, more than one if the frames can't keep up with it
+	/// </summary>
+	uint32_t count;
+};
 
 struct Message
 {
 	enum class Code {
-		LEFT_MOUSE_DOWN,  // data: Pointer to a Point struct containing the point that was left clicked in Window coordinates
-		LEFT_MOUSE_UP,    // data: Pointer to a Point struct containing the point where the left mouse was released in Window coordinates
-		RIGHT_MOUSE_DOWN, // data: Pointer to a Point struct containing the point that was right clicked in Window coordinates
-		RIGHT_MOUSE_UP,   // data: Pointer to a Point struct containing the point where the right mouse was released in Window coordinates
-		MOVING_MOUSE,     // data:
-		MOUSE_LEFT,
-		MOUSE_ENTER,
-		KEY_PRESSED,      // data: Pointer to a KeyMessageInfo struct containing information about the key press
-		KEY_RELEASED,     // data: Pointer to a KeyMessageInfo struct containing information about the key release
-		WINDOW_RESIZED,   // data: Pointer to a Size struct containing the new size
-		GOT_FOCUS,        // data: NULL
-		LOST_FOCUS,       // data: NULL
-		TIMER,
-		CUSTOM
+		LEFT_MOUSE_DOWN,  // point: The point that was left clicked in Window coordinates
+		LEFT_MOUSE_UP,    // point: The point where the left mouse was released in Window coordinates
+		RIGHT_MOUSE_DOWN, // point: The point that was right clicked in Window coordinates
+		RIGHT_MOUSE_UP,   // point: The point where the right mouse was released in Window coordinates
+		MOVING_MOUSE,     // point: The new position of the cursor in Window coordinates
+		MOUSE_LEFT,       // mouse: The state of the mouse buttons
+		MOUSE_ENTER,      // mouse: The state of the mouse buttons
+		KEY_PRESSED,      // key: Information about the key press
+		KEY_RELEASED,     // key: Information about the key release
+		WINDOW_RESIZED,   // size: The new size
+		GOT_FOCUS,        // No payload
+		LOST_FOCUS,       // No payload
+		TIMER,            // timer: The recipient, the id of the timer and how many times it elapsed
+		CUSTOM            // custom: Pointer to a CustomMessageInfo allocated by MessageGenerator::allocateCustomMessageInfo
 	} code;
 
-	void* data;
-};
\ No newline at end of file
+	/// <summary>
+	/// The payload of the message. Which member is valid depends on the code.
+	/// </summary>
+	union
+	{
+		Point point;
+		Size size;
+		KeyMessageInfo key;
+		MouseMessageInfo mouse;
+		TimerMessageInfo timer;
+		CustomMessageInfo* custom;
+	};
+};
@@ -1,20 +1,32 @@
 #include "message_generator.h"
 #include "types.h"
 #include "widget.h"
+#include "backend.h"
 
 #include <sgg/graphics.h>
-#include <list>
+#include <algorithm>
+#include <cstring>
 
-struct TimerInfo {
-	int delay = 0;
-	float time_passed = 0.F;
-	int id = 0;
-	Widget* pTarget = nullptr;
-};
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
-std::list<TimerInfo> g_TimerInfos;
+#define DEFAULT_KEY_REPEAT_DELAY 400
+#define DEFAULT_KEY_REPEAT_INTERVAL 25
 
-#define STRING_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+/// <summary>
+/// Returns the index of the lowest set bit. The value must not be zero.
+/// </summary>
+static inline int lowestSetBit(uint64_t value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
 
 MessageGenerator* MessageGenerator::getInstance()
 {
@@ -23,20 +35,28 @@ MessageGenerator* MessageGenerator::getInstance()
 }
 
 MessageGenerator::MessageGenerator(void)
-	: ptPrevious(0, 0)
+	: m_keyRepeatDelay(DEFAULT_KEY_REPEAT_DELAY), m_keyRepeatInterval(DEFAULT_KEY_REPEAT_INTERVAL),
+	  ptPrevious(0, 0)
 {
-	memset(isKeyPressed, false, sizeof(isKeyPressed));
+	memset(m_keyStates, 0, sizeof(m_keyStates));
+	memset(m_previousKeyStates, 0, sizeof(m_previousKeyStates));
+	memset(&m_keyRepeat, 0, sizeof(m_keyRepeat));
 }
 
-std::vector<Message> MessageGenerator::generateMessages(float delta)
+/// <summary>
+/// Generates the messages for every mouse/keyboard event and timer that has occured since the last call.
+/// </summary>
+/// <param name="delta">Milliseconds passed since last update</param>
+/// <returns>Reference to the generated messages, valid until the next call</returns>
+const std::vector<Message>& MessageGenerator::generateMessages(float delta)
 {
-	std::vector<Message> messages;
+	m_messages.clear();
 
-	generateMouseMessages(messages);
-	generateKeyboardMessages(messages);
-	generateTimerMessages(messages, delta);
+	generateMouseMessages(m_messages);
+	generateKeyboardMessages(m_messages, delta);
+	generateTimerMessages(m_messages, delta);
 
-	return messages;
+	return m_messages;
 }
 
 /// <summary>
@@ -46,24 +66,24 @@ std::vector<Message> MessageGenerator::generateMessages(float delta)
 void MessageGenerator::generateMouseMessages(std::vector<Message>& messages)
 {
 	graphics::MouseState ms;
-	graphics::getMouseState(ms);
+	Backend::get()->getMouseState(ms);
 
 	Message msg = {};
 
-	ms.cur_pos_x = static_cast<int>(graphics::windowToCanvasX((float)ms.cur_pos_x));
-	ms.cur_pos_y = static_cast<int>(graphics::windowToCanvasY((float)ms.cur_pos_y));
+	ms.cur_pos_x = static_cast<int>(Backend::get()->windowToCanvasX((float)ms.cur_pos_x));
+	ms.cur_pos_y = static_cast<int>(Backend::get()->windowToCanvasY((float)ms.cur_pos_y));
 	
 	if (ms.button_left_pressed)
 	{
 		msg.code = Message::Code::LEFT_MOUSE_DOWN;
-		msg.data = new Point(ms.cur_pos_x, ms.cur_pos_y);
+		msg.point = Point(ms.cur_pos_x, ms.cur_pos_y);
 		messages.emplace_back(msg);
 	}
 
 	else if (ms.button_left_released)
 	{
 		msg.code = Message::Code::LEFT_MOUSE_UP;
-		msg.data = new Point(ms.cur_pos_x, ms.cur_pos_y);
+		msg.point = Point(ms.cur_pos_x, ms.cur_pos_y);
 		messages.emplace_back(msg);
 	}
 
@@ -74,14 +94,14 @@ void MessageGenerator::generateMouseMessages(std::vector<Message>& messages)
 	else if (ms.button_right_pressed)
 	{
 		msg.code = Message::Code::RIGHT_MOUSE_DOWN;
-		msg.data = new Point(ms.cur_pos_x, ms.cur_pos_y);
+		msg.point = Point(ms.cur_pos_x, ms.cur_pos_y);
 		messages.emplace_back(msg);
 	}
 
 	else if (ms.button_right_released)
 	{
 		msg.code = Message::Code::RIGHT_MOUSE_UP;
-		msg.data = new Point(ms.cur_pos_x, ms.cur_pos_y);
+		msg.point = Point(ms.cur_pos_x, ms.cur_pos_y);
 		messages.emplace_back(msg);
 	}
 	
@@ -89,7 +109,7 @@ void MessageGenerator::generateMouseMessages(std::vector<Message>& messages)
 	if ((ms.cur_pos_x != ptPrevious.x) || (ms.cur_pos_y != ptPrevious.y))
 	{
 		msg.code = Message::Code::MOVING_MOUSE;
-		msg.data = new Point(ms.cur_pos_x, ms.cur_pos_y);
+		msg.point = Point(ms.cur_pos_x, ms.cur_pos_y);
 		messages.emplace_back(msg);
 	}
 
@@ -97,137 +117,205 @@ void MessageGenerator::generateMouseMessages(std::vector<Message>& messages)
 }
 
 /// <summary>
-/// Generates and appends KEY_PRESSED and KEY_RELEASED messages to the vector.
+/// Generates and appends KEY_PRESSED and KEY_RELEASED messages to the vector,
+/// including the KEY_PRESSED messages of the key that is being held down.
 /// </summary>
 /// <param name="messages"></param>
-void MessageGenerator::generateKeyboardMessages(std::vector<Message>& messages)
+/// <param name="delta">Milliseconds passed since last update</param>
+void MessageGenerator::generateKeyboardMessages(std::vector<Message>& messages, float delta)
 {
+	pollKeyStates();
+
 	const bool shiftPressed = isShiftPressed();
 	const bool ctrlPressed = isCtrlPressed();
 
-	for (int i = 0; i < STRING_SIZE(isKeyPressed); ++i)
+	for (int word = 0; word < KEY_STATE_WORD_COUNT; ++word)
 	{
-		graphics::scancode_t code = (graphics::scancode_t)(i + (int)graphics::scancode_t::SCANCODE_A);
-		bool isPressed = graphics::getKeyState(code);
+		uint64_t changed = m_keyStates[word] ^ m_previousKeyStates[word];
 
-		// Key state has changed (pressed/released)
-		if (isPressed != isKeyPressed[i])
+		while (changed)
 		{
-			KeyMessageInfo* pInfo = new KeyMessageInfo();
-			pInfo->scancode = code;
-			pInfo->key = scancodeToChar(code);
-			pInfo->isShiftPressed = shiftPressed;
-			pInfo->isCtrlPressed = ctrlPressed;
+			const int bit = lowestSetBit(changed);
+			changed &= changed - 1;
+
+			const int index = word * 64 + bit;
+			const bool isPressed = (m_keyStates[word] >> bit) & 1;
 
 			Message message = {};
 			message.code = isPressed ? Message::Code::KEY_PRESSED : Message::Code::KEY_RELEASED;
-			message.data = pInfo;
+			message.key.scancode = static_cast<graphics::scancode_t>(index + graphics::scancode_t::SCANCODE_A);
+			message.key.key = scancodeToChar(message.key.scancode);
+			message.key.isShiftPressed = shiftPressed;
+			message.key.isCtrlPressed = ctrlPressed;
+			message.key.isRepeat = false;
 			messages.emplace_back(message);
+
+			// The last key pressed is the one that gets repeated, like in every text box ever
+			if (isPressed)
+			{
+				m_keyRepeat.isActive = true;
+				m_keyRepeat.keyInfo = message.key;
+				m_keyRepeat.timeHeld = 0.F;
+				m_keyRepeat.timeSinceRepeat = 0.F;
+			}
+
+			else if (m_keyRepeat.isActive && m_keyRepeat.keyInfo.scancode == message.key.scancode)
+			{
+				m_keyRepeat.isActive = false;
+			}
 		}
+	}
+
+	generateKeyRepeatMessages(messages, delta);
+}
+
+/// <summary>
+/// Polls the state of every key into m_keyStates, keeping the state of the previous frame in m_previousKeyStates.
+/// </summary>
+void MessageGenerator::pollKeyStates(void)
+{
+	memcpy(m_previousKeyStates, m_keyStates, sizeof(m_keyStates));
+	memset(m_keyStates, 0, sizeof(m_keyStates));
 
-		isKeyPressed[i] = isPressed;
+	for (int i = 0; i < KEY_STATE_COUNT; ++i)
+	{
+		if (Backend::get()->getKeyState(static_cast<graphics::scancode_t>(i + graphics::scancode_t::SCANCODE_A)))
+		{
+			m_keyStates[i / 64] |= uint64_t(1) << (i % 64);
+		}
 	}
 }
 
 /// <summary>
-/// Generates TIMER messages
+/// Generates the repeated KEY_PRESSED messages of the key that is being held down,
+/// once it has been held for m_keyRepeatDelay and then every m_keyRepeatInterval milliseconds.
 /// </summary>
 /// <param name="messages"></param>
 /// <param name="delta">Milliseconds passed since last update</param>
-void MessageGenerator::generateTimerMessages(std::vector<Message>& messages, float delta)
+void MessageGenerator::generateKeyRepeatMessages(std::vector<Message>& messages, float delta)
 {
-	for (auto it = g_TimerInfos.begin(); it != g_TimerInfos.end(); ++it) 
+	if (!m_keyRepeat.isActive)
 	{
-		it->time_passed += delta;
+		return;
+	}
 
-		if (static_cast<int>(it->time_passed >= it->delay))
-		{
-			it->time_passed = 0.F;
-			
-			TimerMessageInfo* messageInfo = new TimerMessageInfo;
-			messageInfo->pRecipient = it->pTarget;
-			messageInfo->timer_id = it->id;
-			
-			Message message = {};
-			message.code = Message::Code::TIMER;
-			message.data = messageInfo;
-			messages.emplace_back(message);
-		}
+	const bool wasRepeating = m_keyRepeat.timeHeld >= m_keyRepeatDelay;
+	m_keyRepeat.timeHeld += delta;
+
+	if (m_keyRepeat.timeHeld < m_keyRepeatDelay)
+	{
+		return;
+	}
+
+	// The first repeat happens as soon as the delay has passed, the rest every m_keyRepeatInterval
+	m_keyRepeat.timeSinceRepeat = wasRepeating ? m_keyRepeat.timeSinceRepeat + delta : static_cast<float>(m_keyRepeatInterval);
+
+	Message message = {};
+	message.code = Message::Code::KEY_PRESSED;
+	message.key = m_keyRepeat.keyInfo;
+	message.key.isShiftPressed = isShiftPressed();
+	message.key.isCtrlPressed = isCtrlPressed();
+	message.key.isRepeat = true;
+
+	while (m_keyRepeat.timeSinceRepeat >= m_keyRepeatInterval)
+	{
+		m_keyRepeat.timeSinceRepeat -= m_keyRepeatInterval;
+		messages.emplace_back(message);
 	}
 }
 
+/// <summary>
+/// Sets how long a key must be held down before it starts repeating, and how often it repeats after that.
+/// </summary>
+/// <param name="delay">Milliseconds before the first repeat</param>
+/// <param name="interval">Milliseconds between repeats, must be positive</param>
+void MessageGenerator::setKeyRepeat(int delay, int interval)
+{
+	m_keyRepeatDelay = delay;
+	m_keyRepeatInterval = std::max(interval, 1);
+}
+
+/// <summary>
+/// Generates TIMER messages
+/// </summary>
+/// <param name="messages"></param>
+/// <param name="delta">Milliseconds passed since last update</param>
+void MessageGenerator::generateTimerMessages(std::vector<Message>& messages, float delta)
+{
+	m_timerWheel.advance(delta, messages);
+}
+
 /// <summary>
 /// Schedules a TIMER message to be sent to the given widget with the specified id every N milliseconds.
 /// </summary>
 /// <param name="pWidget">Pointer to the widget which shall receive the TIMER messages</param>
 /// <param name="timer_id">The id of the timer</param>
 /// <param name="delay">Time between TIMER messages, in milliseconds</param>
-void MessageGenerator::addTimer(Widget* pWidget, int timer_id, int delay)
+/// <returns>Handle that must be passed to killTimer in order to stop the timer</returns>
+TimerHandle MessageGenerator::addTimer(Widget* pWidget, int timer_id, int delay)
 {
-	auto equalTimer = [&](const TimerInfo& info) {
-		return info.id == timer_id && info.pTarget == pWidget;
-	};
-
-	if (std::find_if(std::begin(g_TimerInfos), std::end(g_TimerInfos), equalTimer) == g_TimerInfos.end())
-	{
-		TimerInfo info;
-		info.delay = delay;
-		info.id = timer_id;
-		info.pTarget = pWidget;
+	return m_timerWheel.add(pWidget, timer_id, delay);
+}
 
-		g_TimerInfos.emplace_back(info);
-	}
+/// <summary>
+/// Stops the timer, the widget will not receive any more TIMER messages from it,
+/// not even the ones that have already been queued.
+/// </summary>
+/// <param name="handle">Handle returned by addTimer</param>
+void MessageGenerator::killTimer(const TimerHandle& handle)
+{
+	m_timerWheel.kill(handle);
 }
 
 /// <summary>
-/// If the given timer exists for the given widget, it will stop receiving the specified timer message
+/// Returns whether the timer hasn't been killed. Used to drop stale TIMER messages.
 /// </summary>
-/// <param name="pWidget">Pointer to the widget that is receiving the timer message</param>
-/// <param name="timer_id">Timer id specified during the call to addTimer</param>
-void MessageGenerator::killTimer(Widget* pWidget, int timer_id)
+bool MessageGenerator::isTimerActive(const TimerHandle& handle) const noexcept
 {
-	auto it = std::find_if(std::begin(g_TimerInfos), std::end(g_TimerInfos), [=](const TimerInfo& info) {
-		return info.id == timer_id && info.pTarget == pWidget;
-	});
+	return m_timerWheel.isActive(handle);
+}
 
-	if (it != std::end(g_TimerInfos))
-	{
-		g_TimerInfos.erase(it);
-	}
+/// <summary>
+/// Allocates the info of a CUSTOM message inside the arena of the current frame.
+/// The info must not be deleted, it is released automatically once the message has been processed.
+/// </summary>
+/// <returns>Pointer to a zero initialized CustomMessageInfo</returns>
+CustomMessageInfo* MessageGenerator::allocateCustomMessageInfo(void)
+{
+	return m_frameArenas[m_currentFrameArena].create<CustomMessageInfo>();
 }
 
-// This function must be called once the message has been processed, otherwise there might be a memory leak.
-void MessageGenerator::deallocateMessage(const Message& msg)
+/// <summary>
+/// Must be called once the event queue has been processed at the end of a frame.
+/// Switches to the other arena, after resetting it and copying into it the data of the messages that
+/// were deferred to the next frame. The arena of this frame is reset at the end of the next one, so
+/// every arena is reset every other frame no matter how many messages are left in the queue.
+/// </summary>
+void MessageGenerator::endFrame(void)
 {
-	switch (msg.code)
-	{
-	case Message::Code::GOT_FOCUS:
-	case Message::Code::LOST_FOCUS:
-		break;
-		
-	default:
-		if (msg.data)
-			delete msg.data;
-	}
+	const int next = 1 - m_currentFrameArena;
+
+	m_frameArenas[next].reset();
+	Widget::moveCustomPayloads(m_frameArenas[next]);
+
+	m_currentFrameArena = next;
 }
 
 /// <summary>
-/// Allocates a MouseMessageInfo struct and fills it with information.
-/// MUST be deleted by the caller.
+/// Fills a MouseMessageInfo struct with the current state of the mouse buttons.
 /// This function exists because some mouse messages are generated outside of this class,
 /// for example during the processing of a message in the messenger class, so we want to
 /// give MessageGenerator the responsibility of initializing the parameters of the new message.
 /// </summary>
-/// <param name="mmi">Reference to the mouse message info struct to be filled</param>
-MouseMessageInfo* MessageGenerator::generateMouseMessageInfo(void)
+MouseMessageInfo MessageGenerator::generateMouseMessageInfo(void)
 {
 	graphics::MouseState ms;
-	graphics::getMouseState(ms);
+	Backend::get()->getMouseState(ms);
 
-	MouseMessageInfo* mmi = new MouseMessageInfo;
-	mmi->isLeftPressed = ms.button_left_down;
-	mmi->isMiddlePressed = ms.button_middle_down;
-	mmi->isRightPressed = ms.button_right_down;
+	MouseMessageInfo mmi = {};
+	mmi.isLeftPressed = ms.button_left_down;
+	mmi.isMiddlePressed = ms.button_middle_down;
+	mmi.isRightPressed = ms.button_right_down;
 
 	return mmi;
 }
@@ -241,10 +329,10 @@ char MessageGenerator::scancodeToChar(graphics::scancode_t code)
 
 bool MessageGenerator::isCtrlPressed(void)
 {
-	return graphics::getKeyState(graphics::scancode_t::SCANCODE_LCTRL) || graphics::getKeyState(graphics::scancode_t::SCANCODE_RCTRL);
+	return Backend::get()->getKeyState(graphics::scancode_t::SCANCODE_LCTRL) || Backend::get()->getKeyState(graphics::scancode_t::SCANCODE_RCTRL);
 }
 
 bool MessageGenerator::isShiftPressed(void)
 {
-	return graphics::getKeyState(graphics::scancode_t::SCANCODE_LSHIFT) || graphics::getKeyState(graphics::scancode_t::SCANCODE_RSHIFT);
+	return Backend::get()->getKeyState(graphics::scancode_t::SCANCODE_LSHIFT) || Backend::get()->getKeyState(graphics::scancode_t::SCANCODE_RSHIFT);
 }
\ No newline at end of file
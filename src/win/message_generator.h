@@ -2,39 +2,15 @@
 
 #include "message.h"
 #include "types.h"
+#include "frame_arena.h"
+#include "timer_wheel.h"
 
 #include <vector>
+#include <cstdint>
 #include <sgg/scancodes.h>
 
-struct KeyMessageInfo
-{
-	graphics::scancode_t scancode;
-	char key;
-
-	bool isShiftPressed;
-	bool isCtrlPressed;	
-};
-
-struct MouseMessageInfo
-{
-	bool isLeftPressed = false;
-	bool isRightPressed = false;
-	bool isMiddlePressed = false;
-};
-
-struct CustomMessageInfo
-{
-	int id;
-	void* data;
-};
-
-class Widget;
-
-struct TimerMessageInfo
-{
-	Widget* pRecipient = nullptr;
-	int timer_id = 0;
-};
+#define KEY_STATE_COUNT (graphics::scancode_t::SCANCODE_KP_PERIOD - graphics::scancode_t::SCANCODE_A + 1)
+#define KEY_STATE_WORD_COUNT ((KEY_STATE_COUNT + 63) / 64)
 
 /// <summary>
 /// This class' responsibility is generating messages upon detecting mouse/keyboard events
@@ -47,18 +23,25 @@ public:
 	MessageGenerator(const MessageGenerator&) = delete;
 	MessageGenerator& operator=(const MessageGenerator&) = delete;
 
-	std::vector<Message> generateMessages(float delta);
-	static void deallocateMessage(const Message&);
-	static MouseMessageInfo* generateMouseMessageInfo(void);
+	const std::vector<Message>& generateMessages(float delta);
+	static MouseMessageInfo generateMouseMessageInfo(void);
+
+	CustomMessageInfo* allocateCustomMessageInfo(void);
+	void endFrame(void);
 
-	void addTimer(Widget*, int timer_id, int delay);
-	void killTimer(Widget*, int timer_id);
+	void setKeyRepeat(int delay, int interval);
+
+	TimerHandle addTimer(Widget*, int timer_id, int delay);
+	void killTimer(const TimerHandle& handle);
+	bool isTimerActive(const TimerHandle& handle) const noexcept;
 
 private:
 	MessageGenerator(void);
 
 	void generateMouseMessages(std::vector<Message>& messages);
-	void generateKeyboardMessages(std::vector<Message>& messages);
+	void generateKeyboardMessages(std::vector<Message>& messages, float delta);
+	void generateKeyRepeatMessages(std::vector<Message>& messages, float delta);
+	void pollKeyStates(void);
 	void generateTimerMessages(std::vector<Message>& messages, float delta);
 
 	static bool isCtrlPressed(void);
@@ -67,13 +50,30 @@ private:
 
 private:
 	/// <summary>
-	/// The library is way too restrictive, so we have to keep track of the key state of every single key
-	/// we care about, so we can send the appropriate message.
-	/// 
-	/// I should mention that the way of setting the array size and iterating it letter is not a good
-	/// idea because the values could change in the future, however I really don't see any other way
+	/// The library can only be asked about one key at a time, so once per frame we poll every key
+	/// we care about (SCANCODE_A up to SCANCODE_KP_PERIOD) into a bitset, one bit per key.
+	/// Comparing it with the bitset of the previous frame 64 keys at a time tells us which keys
+	/// changed state, so the frames where nothing happened cost next to nothing.
 	/// </summary>
-	bool isKeyPressed[graphics::scancode_t::SCANCODE_KP_PERIOD - graphics::scancode_t::SCANCODE_A + 1];
+	uint64_t m_keyStates[KEY_STATE_WORD_COUNT];
+	uint64_t m_previousKeyStates[KEY_STATE_WORD_COUNT];
+
+	/// <summary>
+	/// The key that is currently being repeated, i.e. the last key pressed, as long as it is held down.
+	/// </summary>
+	struct
+	{
+		bool isActive;
+		KeyMessageInfo keyInfo;
+		float timeHeld;
+		float timeSinceRepeat;
+	} m_keyRepeat;
+
+	/// <summary>
+	/// Milliseconds a key must be held before it starts repeating, and milliseconds between repeats
+	/// </summary>
+	int m_keyRepeatDelay;
+	int m_keyRepeatInterval;
 
 	/// <summary>
 	/// Holds the position of the cursor during the previous call to generateMouseMessages.
@@ -81,4 +81,26 @@ private:
 	/// the mouse is moved, the target window will receive infinite MOUSE_MOVE messages.
 	/// </summary>
 	Point ptPrevious;
+
+	/// <summary>
+	/// Schedules the TIMER messages of every Widget
+	/// </summary>
+	TimerWheel m_timerWheel;
+
+	/// <summary>
+	/// The messages generated during the last call to generateMessages.
+	/// Kept around so that its storage is reused every frame.
+	/// </summary>
+	std::vector<Message> m_messages;
+
+	/// <summary>
+	/// Arenas that hold the transient data of the messages posted during a frame. They take turns:
+	/// endFrame resets the other arena, moves the data of the deferred messages into it and makes it current.
+	/// </summary>
+	FrameArena m_frameArenas[2];
+
+	/// <summary>
+	/// Index of the arena used for allocations during the current frame
+	/// </summary>
+	int m_currentFrameArena = 0;
 };
\ No newline at end of file
@@ -2,293 +2,280 @@
 #include "widget.h"
 #include "types.h"
 
-// forwardLeftMouseUp does the same exact thing forwardRightMouseDown
-// and forwardRightMouseUp would do, so we call it instead of defining
-// two new functions. Perhaps it would be wiser to rename it to
-// something along the lines of forwardMouseMessageNoFocus or something idk
-#define forwardRightMouseDown forwardLeftMouseUp
-#define forwardRightMouseUp forwardLeftMouseUp
+#include <vector>
 
 // Found in Widget.cpp
 extern Widget* g_pCursorWidget;
+extern uint32_t g_layoutGeneration;
 
 /// <summary>
-/// Forwards a message sent to a Widget to either itself or a child Widget,
-/// depending on who it is targeted for. For example, if the top level Widget
-/// is clicked, then this function calculates which Widget is below the cursor
-/// and then sends a forwards the message to it with the appropriate parameters.
+/// The Widgets from the root down to the Widget that was last found under the cursor.
+/// As long as nothing has moved and the cursor stays inside the area where that Widget
+/// is guaranteed to be the top-most one, we can skip the descent through the Widget tree.
 /// </summary>
-/// <param name="pWidget">Pointer to the Widget that the message was sent to</param>
+struct HoverPathCache
+{
+	std::vector<Widget*> path;
+
+	/// <summary>
+	/// Intersection of the rectangles of every Widget on the path, in root coordinates.
+	/// </summary>
+	Rect safeRect = Rect(Point(0, 0), Size(0, 0));
+
+	uint32_t generation = 0;
+	bool isValid = false;
+};
+
+static HoverPathCache g_hoverPath;
+
+/// <summary>
+/// Delivers a message sent to a Widget to the Widget it is meant for. For example, if the top level Widget
+/// receives a click, then this function calculates which Widget is below the cursor and delivers the
+/// message to it right away.
+/// 
+/// Input messages travel along the path from the root to the target: first every ancestor gets a chance
+/// to intercept the message in onCaptureMessage (root first), then the target handles it, and then the
+/// message bubbles up through onBubbleMessage (parent first). Any of them can stop the propagation.
+/// </summary>
+/// <param name="pReceiver">Pointer to the Widget that the message was sent to</param>
 /// <param name="message">Message struct generated by MessageGenerator containg information about the message</param>
-bool Messenger::forwardMessage(Widget* pWidget, const Message& message)
+void Messenger::dispatchMessage(Widget* pReceiver, Message& message)
 {
+	Widget* pTarget = nullptr;
+
 	switch (message.code)
 	{
 	case Message::Code::LEFT_MOUSE_DOWN:
-		return forwardLeftMouseDown(pWidget, message);
+		pTarget = resolveLeftMouseDown(pReceiver, message);
+		break;
 
 	case Message::Code::LEFT_MOUSE_UP:
-		return forwardLeftMouseUp(pWidget, message);
-
 	case Message::Code::RIGHT_MOUSE_DOWN:
-		return forwardRightMouseDown(pWidget, message);
-
 	case Message::Code::RIGHT_MOUSE_UP:
-		return forwardRightMouseUp(pWidget, message);
+		pTarget = findWidgetUnderCursor(pReceiver, message.point);
+		break;
 
-	case Message::Code::WINDOW_RESIZED:
-		return forwardResize(pWidget, message);
+	case Message::Code::MOVING_MOUSE:
+		pTarget = resolveMovingMouse(pReceiver, message);
+		break;
 
 	case Message::Code::KEY_PRESSED:
-		return forwardKeyPressed(pWidget, message);
-
 	case Message::Code::KEY_RELEASED:
-		return forwardKeyReleased(pWidget, message);
+		pTarget = resolveKeyMessage(pReceiver);
+		break;
 
 	case Message::Code::GOT_FOCUS:
-		return forwardGotFocus(pWidget, message);
+		// The Widget might have lost the focus again before the message was delivered
+		pTarget = pReceiver->hasFocus() ? pReceiver : nullptr;
+		break;
 
 	case Message::Code::TIMER:
-		return forwardTimer(pWidget, message);
+		pTarget = resolveTimer(message);
+		break;
 
+	case Message::Code::WINDOW_RESIZED:
 	case Message::Code::LOST_FOCUS:
-		return false;
-
-	case Message::Code::MOVING_MOUSE:
-		return forwardDraggingMouse(pWidget, message);
-
 	case Message::Code::MOUSE_LEFT:
-		return false;
-
 	case Message::Code::MOUSE_ENTER:
-		return false;
-
 	case Message::Code::CUSTOM:
-		return false;
+		pTarget = pReceiver;
+		break;
 	}
 
-	return false;
+	if (pTarget)
+	{
+		deliverMessage(pTarget, message);
+	}
 }
 
 /// <summary>
+/// Runs the capture, target and bubble phases of a message whose target is known.
+/// Messages that aren't input, such as timers and custom messages, only go to the target.
 /// </summary>
-/// <param name="pReceiver">Pointer to the Widget that the message was sent to</param>
-/// <param name="message">Message struct containing information</param>
-/// <returns>Zero on success, non-zero on failure</returns>
-bool Messenger::forwardLeftMouseDown(Widget* pReceiver, const Message& message)
+/// <param name="pTarget">Pointer to the Widget the message is meant for</param>
+/// <param name="message">The message. Points are in root coordinates.</param>
+void Messenger::deliverMessage(Widget* pTarget, const Message& message)
 {
-	Point* point = reinterpret_cast<Point*>(message.data);
+	const bool isRouted = isRoutedMessage(message.code);
 
-	Widget* pTarget = findChildWidgetUnderPoint(pReceiver, *point);
+	if (isRouted && pTarget->getParent() && capture(pTarget->getParent(), pTarget, message))
+	{
+		return;
+	}
 
-	if (pTarget)
+	// The target receives points relative to itself, the rest of the path receives them in root coordinates
+	Message targetMessage = message;
+
+	if (hasPoint(message.code))
 	{
-		// If the Widget clicked didn't already have focus, we kill the focus
-		// of the previously focused Widget (if there was one) and we give
-		// the focus to pTarget
-		if (!pTarget->hasFocus())
-		{
-			Widget* pPrevious = Widget::getFocusWidget();
+		absoluteToRelative(targetMessage.point, pTarget);
+	}
 
-			if (pPrevious)
-			{
-				pPrevious->killFocus();
-			}
-			
-			pTarget->setFocus();
-		}
+	// A non-zero return value from the handler stops the message from bubbling up
+	if (pTarget->processMessage(targetMessage) != 0L || !isRouted)
+	{
+		return;
+	}
 
-		if (pTarget == pReceiver)
+	for (Widget* pAncestor = pTarget->getParent(); pAncestor; pAncestor = pAncestor->getParent())
+	{
+		if (pAncestor->onBubbleMessage(message, pTarget))
 		{
-			absoluteToRelative(*point, pTarget);
-			return false;
+			return;
 		}
-
-		pTarget->postMessage(message);
 	}
-
-	return true;
 }
 
 /// <summary>
+/// Calls onCaptureMessage of the given Widget and its ancestors, starting from the root.
+/// Recursion is used so that the path doesn't have to be stored anywhere, the Widget tree is shallow.
 /// </summary>
-/// <param name="pReceiver">Pointer to the Widget that the message was sent to</param>
-/// <param name="message">Message struct containing information</param>
-/// <returns>Zero on success, non-zero on failure</returns>
-bool Messenger::forwardLeftMouseUp(Widget* pReceiver, const Message& message)
+/// <returns>True if one of the Widgets stopped the propagation</returns>
+bool Messenger::capture(Widget* pWidget, Widget* pTarget, const Message& message)
 {
-	Point* point = reinterpret_cast<Point*>(message.data);
-
-	Widget* pTarget = findChildWidgetUnderPoint(pReceiver, *point);
-
-	if (pReceiver == pTarget)
-	{
-		absoluteToRelative(*point, pTarget);
-		return false;
-	}
-
-	else if (pTarget)
+	if (pWidget->getParent() && capture(pWidget->getParent(), pTarget, message))
 	{
-		pTarget->postMessage(message);
+		return true;
 	}
 
-	return true;
+	return pWidget->onCaptureMessage(message, pTarget);
 }
 
 /// <summary>
-/// Always returns false, since a resize message is always meant for the Widget receiving it
+/// Returns whether the message goes through the capture and bubble phases.
 /// </summary>
-/// <param name="pReceiver">Pointer to the receiving Widget.</param>
-/// <param name="message">Pointer to a size struct containing the new dimensions.</param>
-/// <returns></returns>
-bool Messenger::forwardResize(Widget* pReceiver, const Message& message)
+bool Messenger::isRoutedMessage(Message::Code code)
 {
-	return false;
+	switch (code)
+	{
+	case Message::Code::LEFT_MOUSE_DOWN:
+	case Message::Code::LEFT_MOUSE_UP:
+	case Message::Code::RIGHT_MOUSE_DOWN:
+	case Message::Code::RIGHT_MOUSE_UP:
+	case Message::Code::MOVING_MOUSE:
+	case Message::Code::MOUSE_LEFT:
+	case Message::Code::MOUSE_ENTER:
+	case Message::Code::KEY_PRESSED:
+	case Message::Code::KEY_RELEASED:
+		return true;
+
+	default:
+		return false;
+	}
 }
 
 /// <summary>
-/// Forwards the message to the Widget with focus
+/// Returns whether the payload of the message is a point in root coordinates.
 /// </summary>
-/// <param name="pReceiver">Pointer to the receiving Widget.</param>
-/// <param name="message">Pointer to a KeyMessageInfo struct</param>
-/// <returns></returns>
-bool Messenger::forwardKeyPressed(Widget* pReceiver, const Message& message)
+bool Messenger::hasPoint(Message::Code code)
 {
-	Widget* pFocusWidget = Widget::getFocusWidget();
-
-	if (pFocusWidget)
+	switch (code)
 	{
-		if (pFocusWidget == pReceiver)
-		{
-			return false;
-		}
-
-		pFocusWidget->postMessage(message);
+	case Message::Code::LEFT_MOUSE_DOWN:
+	case Message::Code::LEFT_MOUSE_UP:
+	case Message::Code::RIGHT_MOUSE_DOWN:
+	case Message::Code::RIGHT_MOUSE_UP:
+	case Message::Code::MOVING_MOUSE:
 		return true;
-	}
 
-	// If no Widget is focused, then we act as if we didn't forward the message
-	// and we let the top level Widget process this
-	return false;
+	default:
+		return false;
+	}
 }
 
 /// <summary>
-/// Forwards the message to the Widget with focus.
+/// Finds the Widget that was clicked and gives it the focus.
 /// </summary>
-/// <param name="pReceiver">Pointer to the receiving Widget.</param>
-/// <param name="message">Pointer to a KeyMessageInfo struct</param>
-/// <returns></returns>
-bool Messenger::forwardKeyReleased(Widget* pReceiver, const Message& message)
+/// <param name="pReceiver">Pointer to the Widget that the message was sent to</param>
+/// <param name="message">Message struct containing information</param>
+/// <returns>Pointer to the Widget that was clicked, or nullptr</returns>
+Widget* Messenger::resolveLeftMouseDown(Widget* pReceiver, const Message& message)
 {
-	Widget* pFocusWidget = Widget::getFocusWidget();
+	Widget* pTarget = findWidgetUnderCursor(pReceiver, message.point);
 
-	if (pFocusWidget)
+	// If the Widget clicked didn't already have focus, we kill the focus
+	// of the previously focused Widget (if there was one) and we give
+	// the focus to pTarget
+	if (pTarget && !pTarget->hasFocus())
 	{
-		if (pFocusWidget == pReceiver)
+		Widget* pPrevious = Widget::getFocusWidget();
+
+		if (pPrevious)
 		{
-			return false;
+			pPrevious->killFocus();
 		}
 
-		pFocusWidget->postMessage(message);
-		return true;
+		pTarget->setFocus();
 	}
 
-	// If no Widget is focused, then we act as if we didn't forward the message
-	// and we let the top level Widget process this
-	return false;
+	return pTarget;
 }
 
 /// <summary>
-/// Forwards the message to the Widget with focus.
+/// Returns the Widget with focus, or the receiver if no Widget is focused
 /// </summary>
 /// <param name="pReceiver">Pointer to the receiving Widget.</param>
-/// <param name="message">NULL</param>
-/// <returns></returns>
-bool Messenger::forwardGotFocus(Widget* pReceiver, const Message& message)
+Widget* Messenger::resolveKeyMessage(Widget* pReceiver)
 {
-	Widget* pWidget = Widget::getFocusWidget();
-
-	if (pWidget)
-	{
-		if (pWidget == pReceiver)
-		{ 
-			return false;
-		}
-
-		pWidget->postMessage(message);
-		return true;
-	}
+	Widget* pFocusWidget = Widget::getFocusWidget();
 
-	// If no Widget is focused, then we act as if we didn't forward the message
-	// and we let the top level Widget process this
-	return false;
+	// If no Widget is focused, then we let the Widget that received the message process it
+	return pFocusWidget ? pFocusWidget : pReceiver;
 }
 
 /// <summary>
-/// Forwards the message to the Widget underneath the cursor.
-/// Also updates the g_pCursorWidget variable.
+/// Finds the Widget underneath the cursor and updates the g_pCursorWidget variable.
+/// If the cursor moved to another Widget, a MOUSE_LEFT message is delivered to the previous one
+/// and then a MOUSE_ENTER message is delivered to the new one.
 /// </summary>
 /// <param name="pReceiver"></param>
 /// <param name="message"></param>
-/// <returns></returns>
-bool Messenger::forwardDraggingMouse(Widget* pReceiver, const Message& message)
+/// <returns>Pointer to the Widget under the cursor, or nullptr</returns>
+Widget* Messenger::resolveMovingMouse(Widget* pReceiver, const Message& message)
 {
-	Point* point = reinterpret_cast<Point*>(message.data);
-	Widget* pTarget = findChildWidgetUnderPoint(pReceiver, *point);
+	Widget* pTarget = findWidgetUnderCursor(pReceiver, message.point);
 
-	if (pTarget)
+	if (pTarget && g_pCursorWidget != pTarget)
 	{
-		if (pTarget == pReceiver)
-		{
-			// Say for example the cursor Widget, B, is the child of A
-			// Then if we're hovering B, p
-			if (g_pCursorWidget != pTarget)
-			{
-				Message message;
-				message.code = Message::Code::MOUSE_ENTER;
-				message.data = MessageGenerator::generateMouseMessageInfo();
-				pTarget->postMessage(message);
-
-				// If another Widget contained the cursor, post a MOUSE_LEFT message to it
-				if (g_pCursorWidget)
-				{
-					Message message;
-					message.code = Message::Code::MOUSE_LEFT;
-					message.data = MessageGenerator::generateMouseMessageInfo();
-					g_pCursorWidget->postMessage(message);
-				}
-			}
+		// The cursor Widget is updated first, so that the handlers of MOUSE_LEFT
+		// can tell where the cursor went to
+		Widget* pPrevious = g_pCursorWidget;
+		g_pCursorWidget = pTarget;
 
-			// Mark that this Widget contains the cursor
-			g_pCursorWidget = pTarget;
-			absoluteToRelative(*point, pTarget);
-			return false;
+		if (pPrevious)
+		{
+			Message message = {};
+			message.code = Message::Code::MOUSE_LEFT;
+			message.mouse = MessageGenerator::generateMouseMessageInfo();
+			deliverMessage(pPrevious, message);
 		}
 
-		pTarget->postMessage(message);
-		return true;
+		Message message = {};
+		message.code = Message::Code::MOUSE_ENTER;
+		message.mouse = MessageGenerator::generateMouseMessageInfo();
+		deliverMessage(pTarget, message);
 	}
 
-	return false;
+	return pTarget;
 }
 
 /// <summary>
-/// Forwards the message to the widget who is scheduled to receive the timer message
+/// Returns the widget who is scheduled to receive the timer message.
+/// If the timer has been killed since the message was generated, the message is dropped,
+/// since the recipient might not even exist anymore.
 /// </summary>
-/// <param name="pReceiver"></param>
 /// <param name="message"></param>
-/// <returns></returns>
-bool Messenger::forwardTimer(Widget* pReceiver, const Message& message)
+/// <returns>Pointer to the recipient, or nullptr if the message is stale</returns>
+Widget* Messenger::resolveTimer(const Message& message)
 {
-	TimerMessageInfo* pInfo = reinterpret_cast<TimerMessageInfo*>(message.data);
+	const TimerMessageInfo& info = message.timer;
 
-	if (pInfo->pRecipient != pReceiver)
+	if (!MessageGenerator::getInstance()->isTimerActive(info.handle))
 	{
-		pInfo->pRecipient->postMessage(message);
-		return true;
+		return nullptr;
 	}
 
-	return false;
+	return info.pRecipient;
 }
 
 /// <summary>
@@ -303,16 +290,13 @@ bool Messenger::forwardTimer(Widget* pReceiver, const Message& message)
 /// <returns>Pointer to the child Widget under the point</returns>
 Widget* Messenger::findChildWidgetUnderPoint(Widget* pParent, const Point& point)
 {
-	const std::list<Widget*>& children = pParent->getChildren();
+	// If the point that was clicked is inside a child Widget,
+	// then we call the function again to check the children of the child.
+	Widget* pChild = pParent->getChildUnderPoint(point);
 
-	for (auto it = children.rbegin(); it != children.rend(); ++it)
+	if (pChild)
 	{
-		// If the point that was clicked is inside a child Widget,
-		// then we call the function again to check the children of the child.
-		if (isPointInWidget(*it, point))
-		{
-			return findChildWidgetUnderPoint(*it, point);
-		}
+		return findChildWidgetUnderPoint(pChild, point);
 	}
 
 	// When we reach this point, then we know that there aren't any children 
@@ -328,6 +312,96 @@ Widget* Messenger::findChildWidgetUnderPoint(Widget* pParent, const Point& point
 	return nullptr;
 }
 
+/// <summary>
+/// Same as findChildWidgetUnderPoint, but first checks whether the point is still inside the
+/// Widget that was found the last time. Since the cursor usually moves by a few pixels inside
+/// the same Widget, most calls are answered with a single rectangle check.
+/// </summary>
+/// <param name="pReceiver">Pointer to the Widget that the message was sent to</param>
+/// <param name="point">Point in the app Widget.</param>
+/// <returns>Pointer to the Widget under the point</returns>
+Widget* Messenger::findWidgetUnderCursor(Widget* pReceiver, const Point& point)
+{
+	if (g_hoverPath.isValid && g_hoverPath.generation == g_layoutGeneration && g_hoverPath.safeRect.containsPoint(point))
+	{
+		Widget* pLeaf = g_hoverPath.path.back();
+
+		// The cached Widget is only the answer if the search would have gone through it,
+		// and if the cursor hasn't moved on top of one of its own children.
+		if (std::find(g_hoverPath.path.begin(), g_hoverPath.path.end(), pReceiver) != g_hoverPath.path.end()
+			&& !pLeaf->getChildUnderPoint(point))
+		{
+			return pLeaf;
+		}
+	}
+
+	Widget* pTarget = findChildWidgetUnderPoint(pReceiver, point);
+
+	// We only cache searches that started from the root, since otherwise the path would be incomplete
+	if (pTarget && !pReceiver->getParent())
+	{
+		cacheHoverPath(pTarget);
+	}
+
+	return pTarget;
+}
+
+/// <summary>
+/// Remembers the path from the root to the given Widget, along with the area in which
+/// that Widget is guaranteed to be the result of a hit-test.
+/// </summary>
+/// <param name="pLeaf">The Widget that was found under the cursor</param>
+void Messenger::cacheHoverPath(Widget* pLeaf)
+{
+	g_hoverPath.path.clear();
+	g_hoverPath.generation = g_layoutGeneration;
+	g_hoverPath.isValid = true;
+
+	int left = INT32_MIN, top = INT32_MIN, right = INT32_MAX, bottom = INT32_MAX;
+
+	for (Widget* pWidget = pLeaf; pWidget; pWidget = pWidget->getParent())
+	{
+		g_hoverPath.path.emplace_back(pWidget);
+
+		const Point ptAbsolute = pWidget->getAbsolutePosition();
+		left = std::max(left, ptAbsolute.x);
+		top = std::max(top, ptAbsolute.y);
+		right = std::min(right, ptAbsolute.x + static_cast<int>(pWidget->getWidth()));
+		bottom = std::min(bottom, ptAbsolute.y + static_cast<int>(pWidget->getHeight()));
+	}
+
+	std::reverse(g_hoverPath.path.begin(), g_hoverPath.path.end());
+
+	// If a Widget on the path has a sibling on top of it that overlaps the area, then moving the
+	// cursor inside the area could make the search end up in that sibling instead. This is rare,
+	// so in that case we just don't use the cache.
+	for (size_t i = 1; i < g_hoverPath.path.size() && g_hoverPath.isValid; ++i)
+	{
+		const std::list<Widget*>& siblings = g_hoverPath.path[i - 1]->getChildren();
+
+		auto it = std::find(siblings.begin(), siblings.end(), g_hoverPath.path[i]);
+
+		for (++it; it != siblings.end(); ++it)
+		{
+			const Point ptSibling = (*it)->getAbsolutePosition();
+
+			if (ptSibling.x <= right && ptSibling.x + static_cast<int>((*it)->getWidth()) >= left &&
+				ptSibling.y <= bottom && ptSibling.y + static_cast<int>((*it)->getHeight()) >= top)
+			{
+				g_hoverPath.isValid = false;
+				break;
+			}
+		}
+	}
+
+	g_hoverPath.safeRect = Rect(Point(left, top), Size(std::max(right - left, 0), std::max(bottom - top, 0)));
+
+	if (right < left || bottom < top)
+	{
+		g_hoverPath.isValid = false;
+	}
+}
+
 /// <summary>
 /// Converts the given absolute coordinates to relative coordinates (relative to the given Widget)
 /// </summary>
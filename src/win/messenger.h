@@ -6,27 +6,28 @@
 class Widget;
 
 /// <summary>
-/// This class' responsibility is receiving a message and forwarding it to the Widget that it is meant for.
+/// This class' responsibility is receiving a message and delivering it to the Widget that it is meant for.
 /// </summary>
 class Messenger
 {
 public:
-	// Returns true if the message was forwarded
-	// Returns false if it wasn't => The message was meant for the receiver
-	static bool forwardMessage(Widget* pReceiver, const Message& message);
+	static void dispatchMessage(Widget* pReceiver, Message& message);
 
 private:
+	static void deliverMessage(Widget* pTarget, const Message& message);
+	static bool capture(Widget* pWidget, Widget* pTarget, const Message& message);
+	static bool isRoutedMessage(Message::Code code);
+	static bool hasPoint(Message::Code code);
+
 	static bool isPointInWidget(Widget* pWidget, Point point);
 	static void absoluteToRelative(Point& point, Widget* pWidget);
 	
 	static Widget* findChildWidgetUnderPoint(Widget* pParent, const Point&);
+	static Widget* findWidgetUnderCursor(Widget* pReceiver, const Point&);
+	static void cacheHoverPath(Widget* pLeaf);
 
-	static bool forwardLeftMouseDown(Widget* pReceiver, const Message& message);
-	static bool forwardLeftMouseUp(Widget* pReceiver, const Message& message);
-	static bool forwardResize(Widget* pReceiver, const Message& message);
-	static bool forwardKeyPressed(Widget* pReceiver, const Message& message);
-	static bool forwardKeyReleased(Widget* pReceiver, const Message& message);
-	static bool forwardGotFocus(Widget* pReceiver, const Message& message);
-	static bool forwardDraggingMouse(Widget* pReceiver, const Message& message);
-	static bool forwardTimer(Widget* pReceiver, const Message& message);
+	static Widget* resolveLeftMouseDown(Widget* pReceiver, const Message& message);
+	static Widget* resolveMovingMouse(Widget* pReceiver, const Message& message);
+	static Widget* resolveKeyMessage(Widget* pReceiver);
+	static Widget* resolveTimer(const Message& message);
 };
\ No newline at end of file
@@ -1,4 +1,160 @@
 #include "renderer.h"
+#include "backend.h"
+#include "font_metrics.h"
+
+#include <algorithm>
+#include <deque>
+
+/// <summary>
+/// A command waiting in the frame's batch, with its absolute geometry (after clipping)
+/// and the absolute bounds used to find overlaps.
+/// </summary>
+struct QueuedCommand
+{
+	const DrawCommand* pCommand;
+	float x1, y1;
+	float x2, y2;
+	float left, top, right, bottom;
+
+	/// <summary>
+	/// Commands are only reordered within a layer. A command goes on top of the
+	/// highest layer of the earlier commands it overlaps, or one layer above it if
+	/// that command needs a different state.
+	/// </summary>
+	uint32_t layer;
+
+	/// <summary>
+	/// How much of a text command is left visible by the layers above it, see hideCoveredText.
+	/// </summary>
+	float visibility;
+};
+
+struct ClipRect
+{
+	float left, top, right, bottom;
+};
+
+static Renderer::Recording g_recording = { nullptr, Point(0, 0), 0, 0 };
+
+/// <summary>
+/// The render states pushed so far. Each opacity already includes the opacities of the states
+/// below it that belong to the same recording.
+/// </summary>
+static std::vector<Renderer::RenderState> g_stateStack;
+
+/// <summary>
+/// The clip rects pushed so far, in absolute coordinates. Each one is already
+/// intersected with the one below it, if that belongs to the same recording.
+/// </summary>
+static std::vector<ClipRect> g_clipStack;
+
+/// <summary>
+/// The commands of the current frame, in painter's order, until flush() draws them.
+/// </summary>
+static std::vector<QueuedCommand> g_frameCommands;
+
+/// <summary>
+/// Copies of commands that were drawn outside of a recording, which have no list of their own to live in.
+/// A deque, since g_frameCommands points into it.
+/// </summary>
+static std::deque<DrawCommand> g_immediateCommands;
+
+static std::vector<uint32_t> g_batchOrder;
+static Renderer::BatchStats g_batchStats = {};
+
+/// <summary>
+/// Returns the state key of a command. Only rects are drawn with their texture.
+/// </summary>
+static uint32_t getStateKey(DrawCommand::Type type, const Brush& brush) noexcept
+{
+	const TextureHandle texture = (type == DrawCommand::Type::RECT) ? brush.texture : NO_TEXTURE;
+
+	return (texture << 3) | (static_cast<uint32_t>(type) << 1) | (brush.gradient ? 1U : 0U);
+}
+
+static bool overlap(const QueuedCommand& a, const QueuedCommand& b) noexcept
+{
+	return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+/// <summary>
+/// Returns whether the visible part of inner lies inside the visible part of outer. Both are first cut to the
+/// window, so a label that sticks out past the edge of the window still counts as covered by a full-window overlay.
+/// </summary>
+static bool containsOnScreen(const QueuedCommand& outer, const QueuedCommand& inner) noexcept
+{
+	const float innerLeft = std::max(inner.left, 0.F);
+	const float innerTop = std::max(inner.top, 0.F);
+	const float innerRight = std::min(inner.right, static_cast<float>(WINDOW_WIDTH));
+	const float innerBottom = std::min(inner.bottom, static_cast<float>(WINDOW_HEIGHT));
+
+	const float outerLeft = std::max(outer.left, 0.F);
+	const float outerTop = std::max(outer.top, 0.F);
+	const float outerRight = std::min(outer.right, static_cast<float>(WINDOW_WIDTH));
+	const float outerBottom = std::min(outer.bottom, static_cast<float>(WINDOW_HEIGHT));
+
+	return outerLeft <= innerLeft && outerTop <= innerTop && outerRight >= innerRight && outerBottom >= innerBottom;
+}
+
+static bool isText(const QueuedCommand& queued) noexcept
+{
+	return queued.pCommand->type == DrawCommand::Type::TEXT;
+}
+
+/// <summary>
+/// Returns how much of whatever is below a rect the rect hides, assuming that textures are opaque images.
+/// </summary>
+static float getCoverage(const Brush& brush) noexcept
+{
+	return brush.gradient ? std::min(brush.fill_opacity, brush.fill_secondary_opacity) : brush.fill_opacity;
+}
+
+/// <summary>
+/// Limits the clip rect of a command to the given rect, both in the coordinates of the command.
+/// </summary>
+static void clipCommand(DrawCommand& command, float left, float top, float right, float bottom) noexcept
+{
+	if (command.isClipped)
+	{
+		command.clip_left = std::max(command.clip_left, left);
+		command.clip_top = std::max(command.clip_top, top);
+		command.clip_right = std::min(command.clip_right, right);
+		command.clip_bottom = std::min(command.clip_bottom, bottom);
+	}
+	else
+	{
+		command.isClipped = true;
+		command.clip_left = left;
+		command.clip_top = top;
+		command.clip_right = right;
+		command.clip_bottom = bottom;
+	}
+}
+
+static float getCurrentOpacity(void) noexcept
+{
+	return (g_stateStack.size() > g_recording.stateBase) ? g_stateStack.back().opacity : 1.F;
+}
+
+static uint32_t countStateChanges(const std::vector<uint32_t>& order)
+{
+	uint32_t changes = 0;
+	uint32_t previousKey = 0;
+
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		const uint32_t key = g_frameCommands[order[i]].pCommand->stateKey;
+
+		if (i == 0 || key != previousKey)
+		{
+			++changes;
+		}
+
+		previousKey = key;
+	}
+
+	return changes;
+}
 
 /// <summary>
 /// Draws a rectangle positioned relative to the parent of the target Widget.
@@ -8,47 +164,443 @@
 /// <param name="width">Width of the rectangle</param>
 /// <param name="height">Height of the rectangle</param>
 /// <param name="brush">The brush that will be used to draw the rectangle</param>
-void Renderer::drawRect(float center_x, float center_y, float width, float height, const graphics::Brush& brush)
+void Renderer::drawRect(float center_x, float center_y, float width, float height, const Brush& brush)
+{
+	DrawCommand command = { DrawCommand::Type::RECT, center_x, center_y, width, height, std::string(), brush, getStateKey(DrawCommand::Type::RECT, brush) };
+	submit(command, static_cast<float>(m_pTargetWidget->getAbsolutePositionX()), static_cast<float>(m_pTargetWidget->getAbsolutePositionY()));
+}
+
+void Renderer::drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush)
+{	
+	// Measured once here, since the command is replayed for as long as the text doesn't change
+	const float width = FontMetrics::getInstance()->measure(text, size);
+
+	DrawCommand command = { DrawCommand::Type::TEXT, pos_x, pos_y, size, width, text, brush, getStateKey(DrawCommand::Type::TEXT, brush) };
+	submit(command, static_cast<float>(m_pTargetWidget->getAbsolutePositionX()), static_cast<float>(m_pTargetWidget->getAbsolutePositionY()));
+}
+
+void Renderer::drawLine(float x1, float y1, float x2, float y2, const Brush& brush)
+{
+	const int32_t absolute_x = m_pTargetWidget->getAbsolutePositionX();
+	const int32_t absolute_y = m_pTargetWidget->getAbsolutePositionY();
+
+	DrawCommand command = { DrawCommand::Type::LINE, x1, y1, x2, y2, std::string(), brush, getStateKey(DrawCommand::Type::LINE, brush) };
+	submit(command, static_cast<float>(absolute_x), static_cast<float>(absolute_y));
+}
+
+/// <summary>
+/// Clips every following draw call to a rectangle, until popClipRect is called.
+/// Draw calls entirely outside of the rectangle are dropped. Plain filled rectangles that are partly
+/// outside are trimmed. Textures, gradients, outlines and text can't be cut by the backend, so those are drawn whole.
+/// </summary>
+/// <param name="left">Left side of the rectangle, relative to the target Widget</param>
+/// <param name="top">Top side of the rectangle, relative to the target Widget</param>
+/// <param name="width">Width of the rectangle</param>
+/// <param name="height">Height of the rectangle</param>
+void Renderer::pushClipRect(float left, float top, float width, float height)
+{
+	ClipRect clip;
+	clip.left = m_pTargetWidget->getAbsolutePositionX() + left;
+	clip.top = m_pTargetWidget->getAbsolutePositionY() + top;
+	clip.right = clip.left + width;
+	clip.bottom = clip.top + height;
+
+	if (g_clipStack.size() > g_recording.clipBase)
+	{
+		const ClipRect& outer = g_clipStack.back();
+
+		clip.left = std::max(clip.left, outer.left);
+		clip.top = std::max(clip.top, outer.top);
+		clip.right = std::min(clip.right, outer.right);
+		clip.bottom = std::min(clip.bottom, outer.bottom);
+	}
+
+	g_clipStack.emplace_back(clip);
+}
+
+void Renderer::popClipRect(void) noexcept
+{
+	g_clipStack.pop_back();
+}
+
+/// <summary>
+/// Starts recording every draw call into commands instead of sending it to the backend.
+/// </summary>
+/// <param name="commands">The list that the calls will be appended to</param>
+/// <param name="origin">Absolute position that the recorded positions will be relative to</param>
+/// <returns>The recording that was active before, which must be passed to endRecording</returns>
+Renderer::Recording Renderer::beginRecording(DrawCommandList& commands, const Point& origin) noexcept
+{
+	const Recording previous = g_recording;
+
+	g_recording.pCommands = &commands;
+	g_recording.origin = origin;
+	g_recording.clipBase = g_clipStack.size();
+	g_recording.stateBase = g_stateStack.size();
+
+	return previous;
+}
+
+void Renderer::endRecording(const Recording& previous) noexcept
+{
+	g_recording = previous;
+}
+
+/// <summary>
+/// Drops everything recorded so far by the current recording, e.g. because it has been covered up.
+/// </summary>
+void Renderer::discardRecording(void) noexcept
+{
+	if (g_recording.pCommands)
+	{
+		g_recording.pCommands->clear();
+	}
+}
+
+/// <summary>
+/// Makes everything drawn afterwards inherit an opacity, and sets where replayed lists are drawn.
+/// Like clip rects, states only affect the recording they were pushed in. An outer recording applies
+/// its own states when it replays the inner one, so a cached list doesn't depend on its ancestors.
+/// </summary>
+/// <param name="opacity">Opacity to multiply the current opacity with</param>
+/// <param name="offset">Absolute position that replayed command lists are relative to</param>
+void Renderer::pushState(float opacity, const Point& offset)
+{
+	RenderState state;
+	state.opacity = getCurrentOpacity() * opacity;
+	state.offset = offset;
+
+	g_stateStack.emplace_back(state);
+}
+
+void Renderer::popState(void) noexcept
 {
-	if (center_x + width < 0 || center_x - width > WINDOW_WIDTH || center_y + height < 0 || center_y - height > WINDOW_HEIGHT)
+	g_stateStack.pop_back();
+}
+
+/// <summary>
+/// Draws a previously recorded command list at the offset of the current render state, with its opacity.
+/// If another list is being recorded, the commands are appended to it instead, so that a parent can record its children.
+/// </summary>
+/// <param name="commands">The recorded commands</param>
+void Renderer::replay(const DrawCommandList& commands)
+{
+	const Point& origin = g_stateStack.back().offset;
+
+	if (g_recording.pCommands || getCurrentOpacity() != 1.F)
+	{
+		for (DrawCommand command : commands)
+		{
+			submit(command, static_cast<float>(origin.x), static_cast<float>(origin.y));
+		}
+
 		return;
+	}
 
-	graphics::drawRect(
-		m_pTargetWidget->getAbsolutePositionX() + center_x,
-		m_pTargetWidget->getAbsolutePositionY() + center_y,
-		width,
-		height,
-		brush
-	);
+	// The list stays untouched until the next frame, so the batch can point into it
+	for (const DrawCommand& command : commands)
+	{
+		enqueue(command, static_cast<float>(origin.x), static_cast<float>(origin.y));
+	}
 }
 
-void Renderer::drawText(float pos_x, float pos_y, float size, const std::string& text, const graphics::Brush& brush)
-{	
-	const float drawPositionX = m_pTargetWidget->getAbsolutePositionX() + pos_x;
-	const float drawPositionY = m_pTargetWidget->getAbsolutePositionY() + pos_y;
+/// <summary>
+/// Draws every command queued during the frame, layer by layer: first the shapes of a layer, grouped by
+/// state key, then its text. A command is never moved in front of an earlier command that it overlaps,
+/// so the result looks the same as drawing them in the order they were queued.
+/// 
+/// sgg keeps every drawText call until the draw callback returns and then draws all of it over the
+/// shapes, so text can't actually end up below a later layer. Text whose visible part a later rect would
+/// cover is faded out instead; text that a later rect only partly covers is still drawn on top of it.
+/// </summary>
+void Renderer::flush(void)
+{
+	assignLayers();
+	hideCoveredText();
+
+	g_batchOrder.clear();
+
+	for (uint32_t i = 0; i < g_frameCommands.size(); ++i)
+	{
+		if (g_frameCommands[i].visibility > 0.F)
+		{
+			g_batchOrder.emplace_back(i);
+		}
+	}
+
+	g_batchStats.stateChangesBeforeBatching += countStateChanges(g_batchOrder);
 
-	if (drawPositionY >= 0 && drawPositionY - size <= WINDOW_HEIGHT)
+	// Commands with the same layer and state keep their painter's order. Comparing the indices last does
+	// that without std::stable_sort, which allocates a temporary buffer every frame.
+	std::sort(g_batchOrder.begin(), g_batchOrder.end(), [](uint32_t a, uint32_t b) {
+		const QueuedCommand& first = g_frameCommands[a];
+		const QueuedCommand& second = g_frameCommands[b];
+
+		if (first.layer != second.layer)
+		{
+			return first.layer < second.layer;
+		}
+
+		if (isText(first) != isText(second))
+		{
+			return isText(second);
+		}
+
+		if (first.pCommand->stateKey != second.pCommand->stateKey)
+		{
+			return first.pCommand->stateKey < second.pCommand->stateKey;
+		}
+
+		return a < b;
+	});
+
+	g_batchStats.stateChangesAfterBatching += countStateChanges(g_batchOrder);
+	g_batchStats.commands += g_batchOrder.size();
+	++g_batchStats.frames;
+
+	Backend* pBackend = Backend::get();
+
+	for (uint32_t index : g_batchOrder)
+	{
+		const QueuedCommand& queued = g_frameCommands[index];
+		const DrawCommand& command = *queued.pCommand;
+
+		switch (command.type)
+		{
+		case DrawCommand::Type::RECT:
+			pBackend->drawRect(queued.x1, queued.y1, queued.x2, queued.y2, command.brush);
+			break;
+
+		case DrawCommand::Type::TEXT:
+			if (queued.visibility < 1.F)
+			{
+				Brush brush = command.brush;
+				brush.fill_opacity *= queued.visibility;
+				brush.fill_secondary_opacity *= queued.visibility;
+
+				pBackend->drawText(queued.x1, queued.y1, queued.x2, command.text, brush);
+			}
+			else
+			{
+				pBackend->drawText(queued.x1, queued.y1, queued.x2, command.text, command.brush);
+			}
+			break;
+
+		case DrawCommand::Type::LINE:
+			pBackend->drawLine(queued.x1, queued.y1, queued.x2, queued.y2, command.brush);
+			break;
+		}
+	}
+
+	g_frameCommands.clear();
+	g_immediateCommands.clear();
+}
+
+const Renderer::BatchStats& Renderer::getBatchStats(void) noexcept
+{
+	return g_batchStats;
+}
+
+/// <summary>
+/// Sends a draw call to the current recording, or queues it for the end of the frame if nothing is being recorded.
+/// The clip rect and the opacity of the recording, if any, are added to those of the command.
+/// </summary>
+/// <param name="command">The draw call, with the position relative to (offset_x, offset_y)</param>
+/// <param name="offset_x">Absolute horizontal position that the command is relative to</param>
+/// <param name="offset_y">Absolute vertical position that the command is relative to</param>
+void Renderer::submit(DrawCommand& command, float offset_x, float offset_y)
+{
+	// Without a recording the origin is (0, 0), so the command becomes absolute
+	const float dx = offset_x - g_recording.origin.x;
+	const float dy = offset_y - g_recording.origin.y;
+
+	command.x1 += dx;
+	command.y1 += dy;
+
+	if (command.type == DrawCommand::Type::LINE)
 	{
-		graphics::drawText(
-			drawPositionX,
-			drawPositionY,
-			size,
-			text,
-			brush
+		command.x2 += dx;
+		command.y2 += dy;
+	}
+
+	if (command.isClipped)
+	{
+		command.clip_left += dx;
+		command.clip_top += dy;
+		command.clip_right += dx;
+		command.clip_bottom += dy;
+	}
+
+	const float opacity = getCurrentOpacity();
+
+	if (opacity != 1.F)
+	{
+		command.brush.fill_opacity *= opacity;
+		command.brush.fill_secondary_opacity *= opacity;
+		command.brush.outline_opacity *= opacity;
+	}
+
+	if (g_clipStack.size() > g_recording.clipBase)
+	{
+		const ClipRect& clip = g_clipStack.back();
+
+		clipCommand(command,
+			clip.left - g_recording.origin.x,
+			clip.top - g_recording.origin.y,
+			clip.right - g_recording.origin.x,
+			clip.bottom - g_recording.origin.y
 		);
 	}
+
+	if (g_recording.pCommands)
+	{
+		g_recording.pCommands->emplace_back(std::move(command));
+	}
+	else
+	{
+		g_immediateCommands.emplace_back(std::move(command));
+		enqueue(g_immediateCommands.back(), 0.F, 0.F);
+	}
 }
 
-void Renderer::drawLine(float x1, float y1, float x2, float y2, const graphics::Brush& brush)
+/// <summary>
+/// Adds a command to the frame's batch, unless it is off screen or outside of its clip rect.
+/// </summary>
+void Renderer::enqueue(const DrawCommand& command, float offset_x, float offset_y)
 {
-	const int32_t absolute_x = m_pTargetWidget->getAbsolutePositionX();
-	const int32_t absolute_y = m_pTargetWidget->getAbsolutePositionY();
+	QueuedCommand queued;
+	queued.pCommand = &command;
+	queued.x1 = command.x1 + offset_x;
+	queued.y1 = command.y1 + offset_y;
+	queued.x2 = command.x2;
+	queued.y2 = command.y2;
+	queued.layer = 0;
+	queued.visibility = 1.F;
+	queued.left = queued.right = queued.x1;
+	queued.top = queued.bottom = queued.y1;
+
+	switch (command.type)
+	{
+	case DrawCommand::Type::RECT:
+		queued.left = queued.x1 - command.x2 / 2.F;
+		queued.right = queued.x1 + command.x2 / 2.F;
+		queued.top = queued.y1 - command.y2 / 2.F;
+		queued.bottom = queued.y1 + command.y2 / 2.F;
+		break;
+
+	case DrawCommand::Type::TEXT:
+		// The metrics ignore kerning and the glyphs may reach a little past their advance.
+		// Overestimating only keeps a few more commands in order.
+		queued.left = queued.x1;
+		queued.right = queued.x1 + command.y2 + command.x2 / 4.F;
+		queued.top = queued.y1 - command.x2;
+		queued.bottom = queued.y1 + command.x2 / 2.F;
+		break;
+
+	case DrawCommand::Type::LINE:
+		queued.x2 += offset_x;
+		queued.y2 += offset_y;
+		queued.left = std::min(queued.x1, queued.x2);
+		queued.right = std::max(queued.x1, queued.x2);
+		queued.top = std::min(queued.y1, queued.y2);
+		queued.bottom = std::max(queued.y1, queued.y2);
+		break;
+	}
+
+	if (command.isClipped)
+	{
+		const float clip_left = command.clip_left + offset_x;
+		const float clip_top = command.clip_top + offset_y;
+		const float clip_right = command.clip_right + offset_x;
+		const float clip_bottom = command.clip_bottom + offset_y;
+
+		if (queued.right <= clip_left || queued.bottom <= clip_top || queued.left >= clip_right || queued.top >= clip_bottom)
+		{
+			return;
+		}
+
+		const Brush& brush = command.brush;
+
+		if (command.type == DrawCommand::Type::RECT && brush.texture == NO_TEXTURE && !brush.gradient && brush.outline_opacity <= 0.F)
+		{
+			queued.left = std::max(queued.left, clip_left);
+			queued.top = std::max(queued.top, clip_top);
+			queued.right = std::min(queued.right, clip_right);
+			queued.bottom = std::min(queued.bottom, clip_bottom);
+
+			queued.x1 = (queued.left + queued.right) / 2.F;
+			queued.y1 = (queued.top + queued.bottom) / 2.F;
+			queued.x2 = queued.right - queued.left;
+			queued.y2 = queued.bottom - queued.top;
+		}
+	}
 
-	graphics::drawLine(
-		x1 + absolute_x,
-		y1 + absolute_y,
-		x2 + absolute_x,
-		y2 + absolute_y,
-		brush
-	);
-}
\ No newline at end of file
+	// The commands are in absolute coordinates by now, so this is the only place that can tell what's off screen
+	if (queued.right < 0 || queued.bottom < 0 || queued.left > WINDOW_WIDTH || queued.top > WINDOW_HEIGHT)
+	{
+		return;
+	}
+
+	// Rect outlines are centered on the edges and lines have a width, so they reach a little further
+	if (command.type != DrawCommand::Type::TEXT)
+	{
+		queued.left -= 1.F;
+		queued.top -= 1.F;
+		queued.right += 1.F;
+		queued.bottom += 1.F;
+	}
+
+	g_frameCommands.emplace_back(queued);
+}
+
+/// <summary>
+/// Sets the layer of every queued command. A frame only has a couple hundred commands,
+/// so comparing each one with all the earlier ones is cheaper than building an index.
+/// </summary>
+void Renderer::assignLayers(void)
+{
+	for (size_t i = 0; i < g_frameCommands.size(); ++i)
+	{
+		QueuedCommand& current = g_frameCommands[i];
+
+		for (size_t j = 0; j < i; ++j)
+		{
+			const QueuedCommand& earlier = g_frameCommands[j];
+
+			if (overlap(current, earlier))
+			{
+				const uint32_t layer = earlier.layer + (earlier.pCommand->stateKey != current.pCommand->stateKey ? 1 : 0);
+				current.layer = std::max(current.layer, layer);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Fades out text whose visible part lies entirely inside a rect drawn after it, as much as that rect hides what's below it.
+/// An opaque rect hides the text completely and it isn't drawn at all, and while an overlay fades in,
+/// the text below fades out with it. Text that a later rect only partly covers is still drawn whole.
+/// </summary>
+void Renderer::hideCoveredText(void)
+{
+	for (size_t i = 0; i < g_frameCommands.size(); ++i)
+	{
+		QueuedCommand& text = g_frameCommands[i];
+
+		if (!isText(text))
+		{
+			continue;
+		}
+
+		// Anything queued earlier is in the same layer as the text or below it
+		for (size_t j = i + 1; j < g_frameCommands.size() && text.visibility > 0.F; ++j)
+		{
+			const QueuedCommand& later = g_frameCommands[j];
+
+			if (later.pCommand->type == DrawCommand::Type::RECT && containsOnScreen(later, text))
+			{
+				text.visibility *= 1.F - std::min(getCoverage(later.pCommand->brush), 1.F);
+			}
+		}
+	}
+}
@@ -2,7 +2,10 @@
 
 #include <sgg/graphics.h>
 
+#include <string>
+
 #include "widget.h"
+#include "draw_command.h"
 
 #define WINDOW_WIDTH 1370
 #define WINDOW_HEIGHT 720
@@ -10,13 +13,72 @@
 class Renderer
 {
 public:
+	/// <summary>
+	/// The command list that draw calls are currently being recorded into, or none if
+	/// they go straight to the backend. Returned by beginRecording so that it can be restored.
+	/// </summary>
+	struct Recording
+	{
+		DrawCommandList* pCommands;
+		Point origin;
+
+		/// <summary>
+		/// Clip rects below this index of the stack were pushed by an outer recording. They are applied
+		/// when the outer recording replays this one, so that this one doesn't depend on where it is drawn.
+		/// </summary>
+		size_t clipBase;
+		size_t stateBase;
+	};
+
+	/// <summary>
+	/// Inherited by everything drawn until popState is called. The opacity multiplies the opacities of every
+	/// brush, and of the states pushed before it in the same recording. The offset is the absolute position
+	/// that replayed command lists are drawn at.
+	/// </summary>
+	struct RenderState
+	{
+		float opacity;
+		Point offset;
+	};
+
+	/// <summary>
+	/// Totals over every frame flushed so far. A state change is counted whenever a
+	/// command needs a different state key than the command drawn right before it.
+	/// </summary>
+	struct BatchStats
+	{
+		uint64_t frames;
+		uint64_t commands;
+		uint64_t stateChangesBeforeBatching;
+		uint64_t stateChangesAfterBatching;
+	};
+
 	Renderer(Widget* pWidget)
 		: m_pTargetWidget{ pWidget } {}
 
-	void drawRect(float center_x, float center_y, float width, float height, const graphics::Brush&);
-	void drawText(float pos_x, float pos_y, float size, const std::string& text, const graphics::Brush&);
-	void drawLine(float x1, float y1, float x2, float y2, const graphics::Brush&);
+	void drawRect(float center_x, float center_y, float width, float height, const Brush&);
+	void drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush&);
+	void drawLine(float x1, float y1, float x2, float y2, const Brush&);
+
+	void pushClipRect(float left, float top, float width, float height);
+	static void popClipRect(void) noexcept;
+
+	static Recording beginRecording(DrawCommandList& commands, const Point& origin) noexcept;
+	static void endRecording(const Recording& previous) noexcept;
+	static void discardRecording(void) noexcept;
+	static void pushState(float opacity, const Point& offset);
+	static void popState(void) noexcept;
+	static void replay(const DrawCommandList& commands);
+	static void flush(void);
+
+	static const BatchStats& getBatchStats(void) noexcept;
+
+private:
+	static void submit(DrawCommand& command, float offset_x, float offset_y);
+	static void enqueue(const DrawCommand& command, float offset_x, float offset_y);
+	static void assignLayers(void);
+	static void hideCoveredText(void);
 
 private:
 	Widget* m_pTargetWidget;
-};
\ No newline at end of file
+};
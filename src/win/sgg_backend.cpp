@@ -0,0 +1,89 @@
+#include "sgg_backend.h"
+
+#include <algorithm>
+
+void SggBackend::createWindow(const Size& canvasSize, const std::string& title)
+{
+	graphics::createWindow(canvasSize.width, canvasSize.height, title);
+	graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
+	graphics::setCanvasSize((float)canvasSize.width, (float)canvasSize.height);
+}
+
+void SggBackend::setFont(const std::string& fontFile)
+{
+	graphics::setFont(fontFile);
+}
+
+void SggBackend::setCallbacks(UpdateFunction update, DrawFunction draw, ResizeFunction resize)
+{
+	graphics::setDrawFunction(draw);
+	graphics::setUpdateFunction(update);
+	graphics::setResizeFunction(resize);
+}
+
+void SggBackend::startMessageLoop(void)
+{
+	graphics::startMessageLoop();
+}
+
+void SggBackend::drawRect(float center_x, float center_y, float width, float height, const Brush& brush)
+{
+	graphics::drawRect(center_x, center_y, width, height, toSggBrush(brush));
+}
+
+void SggBackend::drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush)
+{
+	graphics::drawText(pos_x, pos_y, size, text, toSggBrush(brush));
+}
+
+void SggBackend::drawLine(float x1, float y1, float x2, float y2, const Brush& brush)
+{
+	graphics::drawLine(x1, y1, x2, y2, toSggBrush(brush));
+}
+
+void SggBackend::getMouseState(graphics::MouseState& ms)
+{
+	graphics::getMouseState(ms);
+}
+
+bool SggBackend::getKeyState(graphics::scancode_t key)
+{
+	return graphics::getKeyState(key);
+}
+
+float SggBackend::windowToCanvasX(float x)
+{
+	return graphics::windowToCanvasX(x);
+}
+
+float SggBackend::windowToCanvasY(float y)
+{
+	return graphics::windowToCanvasY(y);
+}
+
+/// <summary>
+/// Converts a brush to the sgg one. The returned reference is only valid until the next call.
+/// </summary>
+const graphics::Brush& SggBackend::toSggBrush(const Brush& brush)
+{
+	std::copy(brush.fill_color, brush.fill_color + 3, m_brush.fill_color);
+	std::copy(brush.fill_secondary_color, brush.fill_secondary_color + 3, m_brush.fill_secondary_color);
+	m_brush.fill_opacity = brush.fill_opacity;
+	m_brush.fill_secondary_opacity = brush.fill_secondary_opacity;
+
+	std::copy(brush.outline_color, brush.outline_color + 3, m_brush.outline_color);
+	m_brush.outline_opacity = brush.outline_opacity;
+	m_brush.outline_width = brush.outline_width;
+
+	if (brush.texture != m_texture)
+	{
+		m_brush.texture = TextureRegistry::getInstance()->getPath(brush.texture);
+		m_texture = brush.texture;
+	}
+
+	m_brush.gradient = brush.gradient;
+	m_brush.gradient_dir_u = brush.gradient_dir_u;
+	m_brush.gradient_dir_v = brush.gradient_dir_v;
+
+	return m_brush;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "backend.h"
+
+/// <summary>
+/// Backend that forwards everything to the sgg library. This is the only file that calls into sgg,
+/// so builds that use a different backend don't need to link against it.
+/// </summary>
+class SggBackend : public Backend
+{
+public:
+	void createWindow(const Size& canvasSize, const std::string& title) override;
+	void setFont(const std::string& fontFile) override;
+	void setCallbacks(UpdateFunction update, DrawFunction draw, ResizeFunction resize) override;
+	void startMessageLoop(void) override;
+
+	void drawRect(float center_x, float center_y, float width, float height, const Brush& brush) override;
+	void drawText(float pos_x, float pos_y, float size, const std::string& text, const Brush& brush) override;
+	void drawLine(float x1, float y1, float x2, float y2, const Brush& brush) override;
+
+	void getMouseState(graphics::MouseState& ms) override;
+	bool getKeyState(graphics::scancode_t key) override;
+	float windowToCanvasX(float x) override;
+	float windowToCanvasY(float y) override;
+
+private:
+	const graphics::Brush& toSggBrush(const Brush& brush);
+
+private:
+	/// <summary>
+	/// Reused by every draw call. The texture path is only copied into it when the texture changes,
+	/// which the Renderer's batching keeps rare, and the string keeps its buffer, so it doesn't allocate.
+	/// </summary>
+	graphics::Brush m_brush;
+	TextureHandle m_texture = NO_TEXTURE;
+};
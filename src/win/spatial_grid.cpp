@@ -0,0 +1,180 @@
+#include "spatial_grid.h"
+#include "widget.h"
+
+#include <algorithm>
+
+#define GRID_CELL_SIZE 128
+
+/// <summary>
+/// Sets the area covered by the grid and re-inserts the given Widgets.
+/// </summary>
+/// <param name="bounds">Size of the Widget that owns the grid</param>
+/// <param name="widgets">The children of the Widget that owns the grid</param>
+void SpatialGrid::setBounds(const Size& bounds, const std::list<Widget*>& widgets)
+{
+	m_bounds = bounds;
+	m_columns = static_cast<int>(bounds.width) / GRID_CELL_SIZE + 1;
+	m_rows = static_cast<int>(bounds.height) / GRID_CELL_SIZE + 1;
+	m_cells.clear();
+
+	for (Widget* pWidget : widgets)
+	{
+		pWidget->m_GridCellRange = GridCellRange();
+		insert(pWidget);
+	}
+}
+
+void SpatialGrid::allocateCells(void)
+{
+	m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+}
+
+/// <summary>
+/// Adds the Widget to every cell it overlaps.
+/// </summary>
+/// <param name="pWidget">Child of the Widget that owns the grid</param>
+void SpatialGrid::insert(Widget* pWidget)
+{
+	const GridCellRange range = getCellRange(pWidget);
+	pWidget->m_GridCellRange = range;
+
+	if (range.isEmpty())
+	{
+		return;
+	}
+
+	if (m_cells.empty())
+	{
+		allocateCells();
+	}
+
+	for (int row = range.top; row <= range.bottom; ++row)
+	{
+		for (int column = range.left; column <= range.right; ++column)
+		{
+			m_cells[row * m_columns + column].emplace_back(pWidget);
+		}
+	}
+}
+
+/// <summary>
+/// Removes the Widget from every cell it was inserted into.
+/// </summary>
+/// <param name="pWidget">Child of the Widget that owns the grid</param>
+void SpatialGrid::remove(Widget* pWidget)
+{
+	const GridCellRange range = pWidget->m_GridCellRange;
+
+	for (int row = range.top; row <= range.bottom; ++row)
+	{
+		for (int column = range.left; column <= range.right; ++column)
+		{
+			std::vector<Widget*>& cell = m_cells[row * m_columns + column];
+
+			auto it = std::find(cell.begin(), cell.end(), pWidget);
+
+			if (it != cell.end())
+			{
+				// The order inside a cell doesn't matter, so we avoid shifting the rest of the cell
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+
+	pWidget->m_GridCellRange = GridCellRange();
+}
+
+/// <summary>
+/// Must be called whenever the Widget is moved or resized.
+/// </summary>
+/// <param name="pWidget">Child of the Widget that owns the grid</param>
+void SpatialGrid::update(Widget* pWidget)
+{
+	const GridCellRange oldRange = pWidget->m_GridCellRange;
+	const GridCellRange newRange = getCellRange(pWidget);
+
+	// Small moves usually keep the Widget inside the same cells
+	if (oldRange.left == newRange.left && oldRange.right == newRange.right &&
+		oldRange.top == newRange.top && oldRange.bottom == newRange.bottom)
+	{
+		return;
+	}
+
+	remove(pWidget);
+	insert(pWidget);
+}
+
+/// <summary>
+/// Checks whether the point lies in the area covered by the grid.
+/// Children may extend outside of their parent, so if this returns false the grid can't be used.
+/// </summary>
+/// <param name="point">Point relative to the Widget that owns the grid</param>
+bool SpatialGrid::containsPoint(const Point& point) const noexcept
+{
+	return point.x >= 0 && point.x <= static_cast<int>(m_bounds.width)
+		&& point.y >= 0 && point.y <= static_cast<int>(m_bounds.height);
+}
+
+/// <summary>
+/// Finds the top-most Widget containing the point.
+/// </summary>
+/// <param name="point">Point relative to the Widget that owns the grid. Must be inside the grid.</param>
+/// <returns>The top-most Widget under the point, or nullptr if there isn't one</returns>
+Widget* SpatialGrid::findWidgetAt(const Point& point) const
+{
+	if (m_cells.empty())
+	{
+		return nullptr;
+	}
+
+	const int column = std::min(point.x / GRID_CELL_SIZE, m_columns - 1);
+	const int row = std::min(point.y / GRID_CELL_SIZE, m_rows - 1);
+
+	Widget* pResult = nullptr;
+
+	for (Widget* pWidget : m_cells[row * m_columns + column])
+	{
+		const Point position = pWidget->getRelativePosition();
+		const Size size = pWidget->getSize();
+
+		if (point.x >= position.x && point.x <= position.x + static_cast<int>(size.width) &&
+			point.y >= position.y && point.y <= position.y + static_cast<int>(size.height))
+		{
+			if (!pResult || pWidget->m_zOrder > pResult->m_zOrder)
+			{
+				pResult = pWidget;
+			}
+		}
+	}
+
+	return pResult;
+}
+
+/// <summary>
+/// Calculates which cells the Widget overlaps, clamped to the grid.
+/// </summary>
+GridCellRange SpatialGrid::getCellRange(const Widget* pWidget) const noexcept
+{
+	const Point position = pWidget->getRelativePosition();
+	const Size size = pWidget->getSize();
+
+	const int left = position.x;
+	const int top = position.y;
+	const int right = position.x + static_cast<int>(size.width);
+	const int bottom = position.y + static_cast<int>(size.height);
+
+	GridCellRange range;
+
+	if (right < 0 || bottom < 0 || left > static_cast<int>(m_bounds.width) || top > static_cast<int>(m_bounds.height))
+	{
+		return range;
+	}
+
+	range.left = std::max(left, 0) / GRID_CELL_SIZE;
+	range.top = std::max(top, 0) / GRID_CELL_SIZE;
+	range.right = std::min(right / GRID_CELL_SIZE, m_columns - 1);
+	range.bottom = std::min(bottom / GRID_CELL_SIZE, m_rows - 1);
+
+	return range;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "types.h"
+
+#include <list>
+#include <vector>
+
+class Widget;
+
+/// <summary>
+/// Range of grid cells (inclusive) that a Widget has been inserted into.
+/// An empty range means that the Widget is not in the grid, e.g. because it lies completely outside of it.
+/// </summary>
+struct GridCellRange
+{
+	int left = 0;
+	int top = 0;
+	int right = -1;
+	int bottom = -1;
+
+	inline bool isEmpty(void) const noexcept
+	{
+		return left > right || top > bottom;
+	}
+};
+
+/// <summary>
+/// Uniform grid that buckets the children of a Widget by the area they cover,
+/// so that finding the child under a point only has to look at the few children
+/// that overlap the cell containing that point, instead of every child.
+/// 
+/// Coordinates are relative to the top left corner of the Widget that owns the grid,
+/// so moving the owner doesn't require updating the grid.
+/// </summary>
+class SpatialGrid
+{
+public:
+	void setBounds(const Size& bounds, const std::list<Widget*>& widgets);
+
+	void insert(Widget* pWidget);
+	void remove(Widget* pWidget);
+	void update(Widget* pWidget);
+
+	bool containsPoint(const Point& point) const noexcept;
+	Widget* findWidgetAt(const Point& point) const;
+
+private:
+	GridCellRange getCellRange(const Widget* pWidget) const noexcept;
+	void allocateCells(void);
+
+private:
+	Size m_bounds = Size(0, 0);
+	int m_columns = 0;
+	int m_rows = 0;
+
+	/// <summary>
+	/// The Widgets overlapping each cell, stored row by row.
+	/// Only allocated once the first Widget is inserted, since most Widgets never have children.
+	/// </summary>
+	std::vector<std::vector<Widget*>> m_cells;
+};
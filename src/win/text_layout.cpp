@@ -0,0 +1,170 @@
+#include "text_layout.h"
+#include "font_metrics.h"
+
+#include <algorithm>
+#include <functional>
+
+#define ELLIPSIS "..."
+
+static size_t combineHash(size_t seed, size_t value) noexcept
+{
+	return seed ^ (value + 0x9E3779B9 + (seed << 6) + (seed >> 2));
+}
+
+/// <summary>
+/// Finds where the line starting at start has to end so that it fits in maxWidth.
+/// </summary>
+/// <param name="next">Receives where the line after it starts</param>
+/// <returns>One past the last character of the line</returns>
+static size_t findLineEnd(const std::string& text, size_t start, float size, float maxWidth, size_t& next)
+{
+	const FontMetrics* pMetrics = FontMetrics::getInstance();
+
+	float width = 0.F;
+	size_t lastSpace = std::string::npos;
+	size_t i = start;
+
+	for (; i < text.size() && text[i] != '\n'; ++i)
+	{
+		const float advance = pMetrics->getAdvance(text[i], size);
+
+		// A line always gets at least one character, or a narrow maxWidth would never finish
+		if (maxWidth > 0.F && width + advance > maxWidth && i > start && text[i] != ' ')
+		{
+			break;
+		}
+
+		if (text[i] == ' ')
+		{
+			lastSpace = i;
+		}
+
+		width += advance;
+	}
+
+	if (i == text.size() || text[i] == '\n')
+	{
+		next = i + 1;
+		return i;
+	}
+
+	const size_t end = (lastSpace != std::string::npos && lastSpace > start) ? lastSpace : i;
+
+	// The spaces the line was broken at aren't drawn at the start of the next one
+	for (next = end; next < text.size() && text[next] == ' '; ++next);
+
+	return end;
+}
+
+/// <summary>
+/// Returns the text from start up to the end of its line, cut so that it fits in maxWidth with an ellipsis after it.
+/// </summary>
+static std::string ellipsize(const std::string& text, size_t start, float size, float maxWidth)
+{
+	const FontMetrics* pMetrics = FontMetrics::getInstance();
+	const float limit = maxWidth - pMetrics->measure(ELLIPSIS, size);
+
+	float width = 0.F;
+	size_t end = start;
+
+	for (; end < text.size() && text[end] != '\n'; ++end)
+	{
+		const float advance = pMetrics->getAdvance(text[end], size);
+
+		if (maxWidth > 0.F && width + advance > limit)
+		{
+			break;
+		}
+
+		width += advance;
+	}
+
+	while (end > start && text[end - 1] == ' ')
+	{
+		--end;
+	}
+
+	return text.substr(start, end - start) + ELLIPSIS;
+}
+
+TextLayoutCache* TextLayoutCache::getInstance(void)
+{
+	static TextLayoutCache cache;
+	return &cache;
+}
+
+/// <summary>
+/// Returns the layout of a string, laying it out only the first time it is asked for.
+/// The reference stays valid until the next call, since a full cache is emptied before it grows.
+/// </summary>
+/// <param name="text">The string to lay out</param>
+/// <param name="size">Font size the text will be drawn with</param>
+/// <param name="maxWidth">Width the lines have to fit in, or 0 for lines that are only broken at newlines</param>
+/// <param name="maxLines">Number of lines the text may take up, or 0 for no limit. Text that doesn't fit is truncated with an ellipsis.</param>
+const TextLayout& TextLayoutCache::getLayout(const std::string& text, float size, float maxWidth, size_t maxLines)
+{
+	size_t hash = std::hash<std::string>()(text);
+	hash = combineHash(hash, std::hash<float>()(size));
+	hash = combineHash(hash, std::hash<float>()(maxWidth));
+	hash = combineHash(hash, maxLines);
+
+	const auto range = m_entries.equal_range(hash);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const Entry& entry = it->second;
+
+		if (entry.size == size && entry.maxWidth == maxWidth && entry.maxLines == maxLines && entry.text == text)
+		{
+			return entry.layout;
+		}
+	}
+
+	if (m_entries.size() >= TEXT_LAYOUT_CACHE_SIZE)
+	{
+		clear();
+	}
+
+	Entry entry = { text, size, maxWidth, maxLines };
+	layOut(text, size, maxWidth, maxLines, entry.layout);
+
+	return m_entries.emplace(hash, std::move(entry))->second.layout;
+}
+
+/// <summary>
+/// Forgets every layout, e.g. because the font metrics they were made with have changed
+/// </summary>
+void TextLayoutCache::clear(void) noexcept
+{
+	m_entries.clear();
+}
+
+void TextLayoutCache::layOut(const std::string& text, float size, float maxWidth, size_t maxLines, TextLayout& layout)
+{
+	const FontMetrics* pMetrics = FontMetrics::getInstance();
+
+	layout.lines.clear();
+	layout.width = 0.F;
+	layout.isTruncated = false;
+
+	size_t start = 0;
+
+	while (start <= text.size() && (maxLines == 0 || layout.lines.size() < maxLines))
+	{
+		size_t next = 0;
+		const size_t end = findLineEnd(text, start, size, maxWidth, next);
+
+		if (maxLines != 0 && layout.lines.size() + 1 == maxLines && next < text.size())
+		{
+			layout.lines.emplace_back(ellipsize(text, start, size, maxWidth));
+			layout.isTruncated = true;
+		}
+		else
+		{
+			layout.lines.emplace_back(text, start, end - start);
+		}
+
+		layout.width = std::max(layout.width, pMetrics->measure(layout.lines.back(), size));
+		start = next;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define TEXT_LAYOUT_CACHE_SIZE 256
+
+/// <summary>
+/// A string broken into the lines it is drawn as
+/// </summary>
+struct TextLayout
+{
+	std::vector<std::string> lines;
+
+	/// <summary>
+	/// Width of the widest line
+	/// </summary>
+	float width;
+
+	/// <summary>
+	/// Set if the text didn't fit in the lines it was allowed and the last one ends with an ellipsis
+	/// </summary>
+	bool isTruncated;
+};
+
+/// <summary>
+/// Wraps and truncates text using the widths from FontMetrics, and remembers the result, so that
+/// drawing the same text again costs a single lookup. Lines are broken at spaces and newlines,
+/// or inside a word if the word doesn't fit in a line of its own.
+/// </summary>
+class TextLayoutCache
+{
+public:
+	static TextLayoutCache* getInstance(void);
+
+	TextLayoutCache(const TextLayoutCache&) = delete;
+	TextLayoutCache& operator=(const TextLayoutCache&) = delete;
+
+	const TextLayout& getLayout(const std::string& text, float size, float maxWidth = 0.F, size_t maxLines = 0);
+	void clear(void) noexcept;
+
+private:
+	struct Entry
+	{
+		std::string text;
+		float size;
+		float maxWidth;
+		size_t maxLines;
+
+		TextLayout layout;
+	};
+
+	TextLayoutCache(void) = default;
+
+	static void layOut(const std::string& text, float size, float maxWidth, size_t maxLines, TextLayout& layout);
+
+private:
+	/// <summary>
+	/// Keyed by a hash of the text and the parameters, so that a lookup doesn't have to copy the text into a key
+	/// </summary>
+	std::unordered_multimap<size_t, Entry> m_entries;
+};
@@ -0,0 +1,50 @@
+#include "texture_registry.h"
+
+#include <cassert>
+
+TextureRegistry* TextureRegistry::getInstance(void)
+{
+	static TextureRegistry registry;
+	return &registry;
+}
+
+TextureRegistry::TextureRegistry(void)
+	: m_paths{ std::string() }
+{
+	m_handles.emplace(std::string(), NO_TEXTURE);
+}
+
+/// <summary>
+/// Returns the handle of a texture, giving it a new one if the path hasn't been registered before.
+/// </summary>
+/// <param name="path">Path of the image, as sgg expects it</param>
+/// <returns>The handle that brushes should use for the texture</returns>
+TextureHandle TextureRegistry::registerTexture(const std::string& path)
+{
+	const auto result = m_handles.emplace(path, static_cast<TextureHandle>(m_paths.size()));
+
+	if (result.second)
+	{
+		m_paths.emplace_back(path);
+	}
+
+	return result.first->second;
+}
+
+/// <summary>
+/// Changes the image that a handle is drawn with. The handle stays registered under its original path,
+/// and the brushes and recorded draw commands that carry it pick up the new image on their next draw.
+/// </summary>
+/// <param name="handle">A handle returned by registerTexture</param>
+/// <param name="path">Path of the image the handle should stand for from now on</param>
+void TextureRegistry::setPath(TextureHandle handle, const std::string& path)
+{
+	assert(handle != NO_TEXTURE && handle < m_paths.size());
+	m_paths[handle] = path;
+}
+
+const std::string& TextureRegistry::getPath(TextureHandle handle) const noexcept
+{
+	assert(handle < m_paths.size());
+	return m_paths[handle];
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Small integer that stands for the path of a texture. NO_TEXTURE means that nothing is projected on the shape.
+/// </summary>
+typedef uint32_t TextureHandle;
+
+#define NO_TEXTURE 0
+
+/// <summary>
+/// Resolves texture paths to handles. A path is hashed once, when it is registered, usually while
+/// a Widget is being created, and after that brushes and draw commands only carry the handle.
+/// The path is looked up again by the backend, which is the only place that needs it.
+/// Handles are never released, there is only a handful of images per film.
+/// </summary>
+class TextureRegistry
+{
+public:
+	static TextureRegistry* getInstance(void);
+
+	TextureRegistry(const TextureRegistry&) = delete;
+	TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+	TextureHandle registerTexture(const std::string& path);
+	void setPath(TextureHandle handle, const std::string& path);
+	const std::string& getPath(TextureHandle handle) const noexcept;
+
+	/// <summary>
+	/// Returns the number of handles given out so far, including NO_TEXTURE.
+	/// Every handle is smaller than this.
+	/// </summary>
+	inline size_t getHandleCount(void) const noexcept
+	{
+		return m_paths.size();
+	}
+
+private:
+	TextureRegistry(void);
+
+private:
+	/// <summary>
+	/// Indexed by handle. NO_TEXTURE maps to the empty path, like a brush without a texture in sgg.
+	/// </summary>
+	std::vector<std::string> m_paths;
+	std::unordered_map<std::string, TextureHandle> m_handles;
+};
@@ -0,0 +1,175 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SIZE - 1)
+
+static_assert((TIMER_WHEEL_SIZE & TIMER_WHEEL_MASK) == 0, "TIMER_WHEEL_SIZE must be a power of two");
+
+TimerWheel::TimerWheel(void)
+	: m_elapsed(0.0), m_currentTick(0)
+{
+	std::fill(std::begin(m_buckets), std::end(m_buckets), -1);
+}
+
+/// <summary>
+/// Schedules a timer that expires every delay milliseconds, until it is killed.
+/// </summary>
+/// <param name="pTarget">Pointer to the widget which shall receive the TIMER messages</param>
+/// <param name="timer_id">The id of the timer</param>
+/// <param name="delay">Time between TIMER messages, in milliseconds</param>
+/// <returns>Handle used to kill the timer</returns>
+TimerHandle TimerWheel::add(Widget* pTarget, int timer_id, int delay)
+{
+	uint32_t index;
+
+	if (!m_freeSlots.empty())
+	{
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(m_timers.size());
+		m_timers.emplace_back();
+		m_timers[index].generation = 0;
+	}
+
+	Timer& timer = m_timers[index];
+	timer.pTarget = pTarget;
+	timer.id = timer_id;
+	// A timer that expires on the current tick would land on a bucket that has already been visited
+	timer.delay = static_cast<uint32_t>(std::max(delay, 1));
+	timer.deadline = m_currentTick + timer.delay;
+	timer.isActive = true;
+
+	link(index);
+
+	TimerHandle handle;
+	handle.slot = index;
+	handle.generation = timer.generation;
+	return handle;
+}
+
+/// <summary>
+/// Stops the timer. TIMER messages of the timer that are still queued become stale, see isActive.
+/// Killing a timer that has already been killed does nothing.
+/// </summary>
+void TimerWheel::kill(const TimerHandle& handle)
+{
+	if (!isActive(handle))
+	{
+		return;
+	}
+
+	Timer& timer = m_timers[handle.slot];
+	unlink(handle.slot);
+
+	timer.isActive = false;
+	++timer.generation;
+
+	m_freeSlots.push_back(handle.slot);
+}
+
+/// <summary>
+/// Returns whether the timer referenced by the handle hasn't been killed yet.
+/// </summary>
+bool TimerWheel::isActive(const TimerHandle& handle) const noexcept
+{
+	return handle.slot < m_timers.size()
+		&& m_timers[handle.slot].isActive
+		&& m_timers[handle.slot].generation == handle.generation;
+}
+
+/// <summary>
+/// Moves the clock forward and generates a TIMER message for every timer that expired.
+/// A timer that expired more than once, because the clock moved by more than its delay,
+/// generates a single message with the number of times it expired, and keeps its period.
+/// </summary>
+/// <param name="delta">Milliseconds passed since last update</param>
+/// <param name="messages">Vector the TIMER messages are appended to</param>
+void TimerWheel::advance(float delta, std::vector<Message>& messages)
+{
+	m_elapsed += delta;
+
+	const uint64_t newTick = static_cast<uint64_t>(m_elapsed);
+	const uint64_t ticks = std::min<uint64_t>(newTick - m_currentTick, TIMER_WHEEL_SIZE);
+
+	for (uint64_t tick = 1; tick <= ticks; ++tick)
+	{
+		int32_t index = m_buckets[(m_currentTick + tick) & TIMER_WHEEL_MASK];
+
+		while (index != -1)
+		{
+			Timer& timer = m_timers[index];
+			const int32_t next = timer.next;
+
+			if (timer.deadline <= newTick)
+			{
+				unlink(index);
+				m_expired.push_back(index);
+
+				// If the clock moved by more than one period, the timer elapsed more than once
+				const uint32_t count = static_cast<uint32_t>((newTick - timer.deadline) / timer.delay) + 1;
+				timer.deadline += static_cast<uint64_t>(count) * timer.delay;
+
+				Message message = {};
+				message.code = Message::Code::TIMER;
+				message.timer.pRecipient = timer.pTarget;
+				message.timer.timer_id = timer.id;
+				message.timer.handle.slot = index;
+				message.timer.handle.generation = timer.generation;
+				message.timer.count = count;
+				messages.emplace_back(message);
+			}
+
+			index = next;
+		}
+	}
+
+	m_currentTick = newTick;
+
+	// The expired timers are linked into the bucket of their new deadline only now,
+	// otherwise a timer could end up in a bucket that hasn't been visited yet and expire twice
+	for (uint32_t index : m_expired)
+	{
+		link(index);
+	}
+
+	m_expired.clear();
+}
+
+void TimerWheel::link(uint32_t index)
+{
+	Timer& timer = m_timers[index];
+	int32_t& head = m_buckets[timer.deadline & TIMER_WHEEL_MASK];
+
+	timer.previous = -1;
+	timer.next = head;
+
+	if (head != -1)
+	{
+		m_timers[head].previous = index;
+	}
+
+	head = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+	Timer& timer = m_timers[index];
+
+	if (timer.previous != -1)
+	{
+		m_timers[timer.previous].next = timer.next;
+	}
+	else
+	{
+		m_buckets[timer.deadline & TIMER_WHEEL_MASK] = timer.next;
+	}
+
+	if (timer.next != -1)
+	{
+		m_timers[timer.next].previous = timer.previous;
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "message.h"
+#include "types.h"
+
+#include <cstdint>
+#include <vector>
+
+#define TIMER_WHEEL_SIZE 256
+
+class Widget;
+
+/// <summary>
+/// Hashed timing wheel that schedules the TIMER messages.
+/// Each timer is stored in the bucket of the millisecond its deadline falls on (modulo the wheel size),
+/// so advancing the clock only has to look at the buckets the clock moved over, instead of every timer.
+/// Timers whose deadline is more than a whole turn away simply stay in their bucket until their turn comes.
+/// 
+/// Timers are stored in a pool and are referenced through handles, so adding and killing one is O(1).
+/// </summary>
+class TimerWheel
+{
+public:
+	TimerWheel(void);
+
+	TimerHandle add(Widget* pTarget, int timer_id, int delay);
+	void kill(const TimerHandle& handle);
+	bool isActive(const TimerHandle& handle) const noexcept;
+
+	void advance(float delta, std::vector<Message>& messages);
+
+private:
+	struct Timer
+	{
+		Widget* pTarget;
+		int id;
+		uint32_t delay;
+		uint64_t deadline;
+		uint32_t generation;
+		bool isActive;
+
+		/// <summary>
+		/// Neighbours inside the bucket, -1 if there are none
+		/// </summary>
+		int32_t previous;
+		int32_t next;
+	};
+
+	void link(uint32_t index);
+	void unlink(uint32_t index);
+
+private:
+	std::vector<Timer> m_timers;
+	std::vector<uint32_t> m_freeSlots;
+
+	/// <summary>
+	/// Index of the first timer in each bucket, -1 if the bucket is empty
+	/// </summary>
+	int32_t m_buckets[TIMER_WHEEL_SIZE];
+
+	/// <summary>
+	/// Milliseconds passed since the wheel was created
+	/// </summary>
+	double m_elapsed;
+	uint64_t m_currentTick;
+
+	/// <summary>
+	/// Timers that expired during the current call to advance, reused between calls
+	/// </summary>
+	std::vector<uint32_t> m_expired;
+};
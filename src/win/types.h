@@ -36,4 +36,13 @@ typedef struct RectI
 		return (p.x >= point.x && p.x <= point.x + static_cast<int>(size.width)) 
 			&& (p.y >= point.y && p.y <= point.y + static_cast<int>(size.height));
 	}
-} Rect;
\ No newline at end of file
+} Rect;
+/// <summary>
+/// Identifies a timer scheduled in the TimerWheel. The generation changes every time the slot
+/// is reused, so a handle to a timer that has been killed never matches a newer timer.
+/// </summary>
+typedef struct TimerHandleU
+{
+	uint32_t slot;
+	uint32_t generation;
+} TimerHandle;
@@ -1,8 +1,23 @@
 #include "widget.h"
 #include "renderer.h"
 #include "messenger.h"
+#include "event_queue.h"
+#include "backend.h"
 
 #include <cassert>
+#include <chrono>
+#include <iterator>
+
+/// <summary>
+/// Milliseconds per frame that may be spent on layout, custom and timer messages
+/// </summary>
+#define LOW_PRIORITY_BUDGET_MS 4.0F
+
+/// <summary>
+/// Widgets draw a little outside of their bounds (film buttons grow when hovered, slider values
+/// sit above the slider), so they are only culled once they are this many pixels off screen
+/// </summary>
+#define CULL_MARGIN 32
 
 #ifdef _DEBUG
 
@@ -35,11 +50,23 @@ Widget* g_pCursorWidget = nullptr;
 /// </summary>
 Widget* g_pFocusWidget = nullptr;
 
+/// <summary>
+/// Incremented whenever a Widget is moved, resized, added, removed or brought to the top,
+/// i.e. whenever the result of a hit-test may have changed.
+/// </summary>
+uint32_t g_layoutGeneration = 0;
+
+/// <summary>
+/// Every message posted to any Widget, in the order they were posted
+/// </summary>
+EventQueue g_eventQueue;
+
 Widget::Widget(const Size& size, const Point& position, Widget* pParent) noexcept
 {
 	m_pParent = pParent;
 	m_Size = size;
-	setRelativePosition(position);
+	m_RelativePosition = position;
+	m_ChildGrid.setBounds(size, m_Children);
 	setBackgroundColor(1.0f, 1.0f, 1.0f);
 	
 	if (pParent)
@@ -48,6 +75,19 @@ Widget::Widget(const Size& size, const Point& position, Widget* pParent) noexcep
 	}
 }
 
+/// <summary>
+/// Kills the timers of the Widget and drops the messages posted to it, so that no message reaches it after it has been deleted.
+/// </summary>
+Widget::~Widget(void)
+{
+	for (const RunningTimer& timer : m_Timers)
+	{
+		MessageGenerator::getInstance()->killTimer(timer.handle);
+	}
+
+	g_eventQueue.removeTarget(this);
+}
+
 /// <summary>
 /// 
 /// </summary>
@@ -81,10 +121,13 @@ uint32_t Widget::getHeight(void) const noexcept
 void Widget::setSize(const Size& size) noexcept
 {
 	m_Size = size;
+	m_ChildGrid.setBounds(m_Size, m_Children);
+	updateParentGrid();
+	invalidate();
 
 	Message message = {};
 	message.code = Message::Code::WINDOW_RESIZED;
-	message.data = new Size(size);
+	message.size = size;
 	postMessage(message);
 }
 
@@ -96,10 +139,13 @@ void Widget::setSize(const Size& size) noexcept
 void Widget::setWidth(uint32_t width) noexcept
 {
 	m_Size.width = width;
+	m_ChildGrid.setBounds(m_Size, m_Children);
+	updateParentGrid();
+	invalidate();
 
 	Message message = {};
 	message.code = Message::Code::WINDOW_RESIZED;
-	message.data = new Size(width, m_Size.height);
+	message.size = Size(width, m_Size.height);
 	postMessage(message);
 }
 
@@ -111,10 +157,13 @@ void Widget::setWidth(uint32_t width) noexcept
 void Widget::setHeight(uint32_t height) noexcept
 {
 	m_Size.height = height;
+	m_ChildGrid.setBounds(m_Size, m_Children);
+	updateParentGrid();
+	invalidate();
 
 	Message message = {};
 	message.code = Message::Code::WINDOW_RESIZED;
-	message.data = new Size(m_Size.width, height);
+	message.size = Size(m_Size.width, height);
 	postMessage(message);
 }
 
@@ -125,45 +174,34 @@ void Widget::setHeight(uint32_t height) noexcept
 /// <returns></returns>
 Point Widget::getRelativePosition(void) const noexcept
 {
-	Point ptResult = {};
-	ptResult.x = getRelativePositionX();
-	ptResult.y = getRelativePositionY();
-
-	return ptResult;
+	return m_RelativePosition;
 }
 
 int32_t Widget::getRelativePositionX(void) const noexcept
 {
-	if (m_pParent)
-	{
-		return m_AbsolutePosition.x - m_pParent->getRelativePositionX();
-	}
-
-	return m_AbsolutePosition.x;
+	return m_RelativePosition.x;
 }
 
 int32_t Widget::getRelativePositionY(void) const noexcept
 {
-	if (m_pParent)
-	{
-		return m_AbsolutePosition.y - m_pParent->getRelativePositionY();
-	}
-
-	return m_AbsolutePosition.y;
+	return m_RelativePosition.y;
 }
 
 Point Widget::getAbsolutePosition(void) const noexcept
 {
+	resolveTransform();
 	return m_AbsolutePosition;
 }
 
 int32_t Widget::getAbsolutePositionX(void) const noexcept
 {
+	resolveTransform();
 	return m_AbsolutePosition.x;
 }
 
 int32_t Widget::getAbsolutePositionY(void) const noexcept
 {
+	resolveTransform();
 	return m_AbsolutePosition.y;
 }
 
@@ -174,8 +212,15 @@ int32_t Widget::getAbsolutePositionY(void) const noexcept
 /// <returns>Nothing</returns>
 void Widget::setRelativePosition(const Point& pos) noexcept
 {
-	setRelativePositionX(pos.x);
-	setRelativePositionY(pos.y);
+	m_RelativePosition = pos;
+	invalidateTransform();
+	updateParentGrid();
+
+	// The cached commands of the Widget are relative to itself, only the parent has to draw it somewhere else
+	if (m_pParent)
+	{
+		m_pParent->invalidate();
+	}
 }
 
 /// <summary>
@@ -185,14 +230,15 @@ void Widget::setRelativePosition(const Point& pos) noexcept
 /// <returns></returns>
 void Widget::setRelativePositionX(int32_t x) noexcept
 {
-	int32_t newAbsolutePosX = m_pParent ? x + m_pParent->getAbsolutePositionX() : x;
+	m_RelativePosition.x = x;
+	invalidateTransform();
+	updateParentGrid();
 
-	for (Widget* pChild : m_Children) 
+	// The cached commands of the Widget are relative to itself, only the parent has to draw it somewhere else
+	if (m_pParent)
 	{
-		pChild->m_AbsolutePosition.x = (newAbsolutePosX + pChild->getRelativePositionX());
+		m_pParent->invalidate();
 	}
-
-	m_AbsolutePosition.x = newAbsolutePosX;
 }
 
 /// <summary>
@@ -202,14 +248,71 @@ void Widget::setRelativePositionX(int32_t x) noexcept
 /// <returns></returns>
 void Widget::setRelativePositionY(int32_t y) noexcept
 {
-	int32_t newAbsolutePosY = m_pParent ? y + m_pParent->getAbsolutePositionY() : y;
+	m_RelativePosition.y = y;
+	invalidateTransform();
+	updateParentGrid();
+
+	// The cached commands of the Widget are relative to itself, only the parent has to draw it somewhere else
+	if (m_pParent)
+	{
+		m_pParent->invalidate();
+	}
+}
+
+/// <summary>
+/// Marks the absolute position of the Widget and of every descendant as out of date.
+/// Since a dirty Widget always has dirty descendants, we can stop at any Widget that is
+/// already dirty, so moving the same container many times in a row only walks the subtree once.
+/// </summary>
+void Widget::invalidateTransform(void) noexcept
+{
+	if (m_isTransformDirty)
+	{
+		return;
+	}
+
+	m_isTransformDirty = true;
 
 	for (Widget* pChild : m_Children)
 	{
-		pChild->m_AbsolutePosition.y = newAbsolutePosY + pChild->getRelativePositionY();
+		pChild->invalidateTransform();
+	}
+}
+
+/// <summary>
+/// Recalculates the cached absolute position if the Widget has moved since it was last calculated.
+/// The ancestors are resolved first, so this costs nothing if the position is already up to date.
+/// </summary>
+void Widget::resolveTransform(void) const noexcept
+{
+	if (!m_isTransformDirty)
+	{
+		return;
 	}
 
-	m_AbsolutePosition.y = newAbsolutePosY;
+	m_AbsolutePosition = m_RelativePosition;
+
+	if (m_pParent)
+	{
+		const Point ptParent = m_pParent->getAbsolutePosition();
+		m_AbsolutePosition.x += ptParent.x;
+		m_AbsolutePosition.y += ptParent.y;
+	}
+
+	m_isTransformDirty = false;
+}
+
+/// <summary>
+/// Lets the parent know that the area covered by the Widget has changed, so it can update its spatial index.
+/// </summary>
+void Widget::updateParentGrid(void)
+{
+	++g_layoutGeneration;
+
+	if (m_pParent)
+	{
+		m_pParent->m_ChildGrid.update(this);
+	}
 }
 
 /// <summary>
@@ -221,7 +324,6 @@ void Widget::setFocus(void) noexcept
 
 	Message message = {};
 	message.code = Message::Code::GOT_FOCUS;
-	message.data = nullptr;
 	postMessage(message);
 }
 
@@ -247,7 +349,6 @@ void Widget::killFocus(void) noexcept
 
 		Message message = {};
 		message.code = Message::Code::LOST_FOCUS;
-		message.data = nullptr;
 		postMessage(message);
 	}
 }
@@ -277,7 +378,7 @@ Widget* Widget::getCursorWidget(void) noexcept
 void Widget::getRelativeCursorPosition(Point& out) const noexcept
 {
 	graphics::MouseState ms;
-	graphics::getMouseState(ms);
+	Backend::get()->getMouseState(ms);
 
 	out.x = ms.cur_pos_x - getAbsolutePositionX();
 	out.y = ms.cur_pos_y - getAbsolutePositionY();
@@ -291,6 +392,38 @@ const std::list<Widget*>& Widget::getChildren(void) const noexcept
 	return m_Children;
 }
 
+/// <summary>
+/// Finds the top-most child that contains the given point.
+/// </summary>
+/// <param name="point">Point relative to the top left of the root Widget</param>
+/// <returns>The child under the point, or nullptr if there isn't one</returns>
+Widget* Widget::getChildUnderPoint(const Point& point) const
+{
+	const Point ptAbsolute = getAbsolutePosition();
+	const Point ptRelative(point.x - ptAbsolute.x, point.y - ptAbsolute.y);
+
+	if (m_ChildGrid.containsPoint(ptRelative))
+	{
+		return m_ChildGrid.findWidgetAt(ptRelative);
+	}
+
+	// Children may extend outside of the Widget, in which case the grid doesn't
+	// cover the point and we have to check every child.
+	for (auto it = m_Children.rbegin(); it != m_Children.rend(); ++it)
+	{
+		const Point ptChild = (*it)->getRelativePosition();
+		const Size size = (*it)->getSize();
+
+		if (ptRelative.x >= ptChild.x && ptRelative.x <= ptChild.x + static_cast<int>(size.width) &&
+			ptRelative.y >= ptChild.y && ptRelative.y <= ptChild.y + static_cast<int>(size.height))
+		{
+			return *it;
+		}
+	}
+
+	return nullptr;
+}
+
 /// <summary>
 /// Removes a child window, if it exists.
 /// </summary>
@@ -318,7 +451,12 @@ void Widget::removeChild(Widget* pWidget)
 
 		pWidget->cleanup();
 
+		m_ChildGrid.remove(pWidget);
 		m_Children.erase(it);
+
+		++g_layoutGeneration;
+
+		invalidate();
 	}
 }
 
@@ -389,28 +527,112 @@ Widget* Widget::getRoot(void) noexcept
 }
 
 /// <summary>
-/// Pops a message from the message queue (inbox) and forwards it to the appropriate Widget.
+/// Pops messages from the event queue and dispatches them to the appropriate Widget,
+/// including the messages that are posted while doing so.
+/// Input messages are always processed first and are never deferred. The rest are processed
+/// as long as the time spent on them during this call stays inside LOW_PRIORITY_BUDGET_MS,
+/// whatever is left stays in the queue for the next frame.
+/// Only needs to be called on the root Widget, since the queue is shared by every Widget.
 /// </summary>
 void Widget::update(float ms)
 {
-	while (!m_Inbox.empty())
+	using Clock = std::chrono::steady_clock;
+
+	Widget* pReceiver;
+	Message msg;
+	Clock::duration lowPriorityTime = Clock::duration::zero();
+
+	while (true)
 	{
-		Message msg = m_Inbox.front();
-		m_Inbox.pop();
+		if (g_eventQueue.pop(EventLane::INPUT, pReceiver, msg))
+		{
+			dispatchMessage(pReceiver, msg);
+			continue;
+		}
+
+		if (lowPriorityTime >= std::chrono::duration<float, std::milli>(LOW_PRIORITY_BUDGET_MS))
+		{
+			break;
+		}
 
-		if (!Messenger::forwardMessage(this, msg))
+		// Input that is posted while handling one of these is picked up in the next iteration
+		if (g_eventQueue.pop(EventLane::LAYOUT, pReceiver, msg) || g_eventQueue.pop(EventLane::TIMER, pReceiver, msg))
 		{
+			const Clock::time_point start = Clock::now();
+			dispatchMessage(pReceiver, msg);
+			lowPriorityTime += Clock::now() - start;
+			continue;
+		}
+
+		break;
+	}
+}
+
+/// <summary>
+/// Moves the payloads of the CUSTOM messages that were deferred to the next frame into the given arena.
+/// </summary>
+void Widget::moveCustomPayloads(FrameArena& arena)
+{
+	g_eventQueue.moveCustomPayloads(arena);
+}
+
+void Widget::dispatchMessage(Widget* pReceiver, Message& message)
+{
 #ifdef _DEBUG
-			printf("Widget: %x, Message: %s\n", this, g_messageNames[(int)msg.code]);
+	printf("Widget: %x, Message: %s\n", pReceiver, g_messageNames[(int)message.code]);
 #endif
-			processMessage(msg);
-			MessageGenerator::deallocateMessage(msg);
-		}
+	Messenger::dispatchMessage(pReceiver, message);
+}
+
+/// <summary>
+/// Marks the draw commands of the Widget, and of every ancestor since they include
+/// the commands of their children, as out of date, so that they are recorded again on the next frame.
+/// Must be called whenever something the Widget draws changes outside of a message handler.
+/// </summary>
+void Widget::invalidate(void) noexcept
+{
+	// We can't stop at a Widget that is already dirty: hidden Widgets are never drawn,
+	// so they can stay dirty while their parent has been recorded without them.
+	for (Widget* pWidget = this; pWidget; pWidget = pWidget->m_pParent)
+	{
+		pWidget->m_isDrawCacheDirty = true;
+	}
+}
+
+/// <summary>
+/// Draws the Widget and its children. The draw calls made by draw() are recorded the first time,
+/// and replayed on every following frame until the Widget is invalidated, so that an idle tree
+/// costs no more than the draw calls themselves.
+/// </summary>
+void Widget::render(void)
+{
+	const Point position = getAbsolutePosition();
+
+	// Which children were culled depends on where the Widget is on the screen
+	const bool hasMoved = (position.x != m_recordedPosition.x || position.y != m_recordedPosition.y);
+
+	if (m_isDrawCacheDirty || (m_dependsOnViewport && hasMoved))
+	{
+		m_DrawCommands.clear();
+		m_dependsOnViewport = false;
+		m_recordedPosition = position;
+
+		const Renderer::Recording previous = Renderer::beginRecording(m_DrawCommands, position);
+		draw();
+		Renderer::endRecording(previous);
+
+		m_isDrawCacheDirty = false;
 	}
 
-	for (Widget* pChild : getChildren())
+	// The list doesn't include the opacity of the Widget, so a fade only has to replay it differently
+	Renderer::pushState(m_opacity, position);
+	Renderer::replay(m_DrawCommands);
+	Renderer::popState();
+
+	// The root is rendered last, so the whole frame has been queued
+	if (!m_pParent)
 	{
-		pChild->update(ms);
+		Renderer::flush();
 	}
 }
 
@@ -439,18 +661,111 @@ void Widget::drawBackground(void) noexcept
 }
 
 /// <summary>
-/// Calls the draw function for each child Widget.
+/// Renders each visible child Widget. Children that are entirely off screen, outside of this
+/// Widget if it clips its children, or below a child that occludes the window are skipped
+/// along with all of their descendants.
 /// </summary>
 /// <param name=""></param>
 void Widget::drawChildren(void) noexcept
 {
-	for (Widget* pChildWidget : m_Children)
+	Renderer renderer(this);
+
+	if (m_clipsChildren)
 	{
+		renderer.pushClipRect(0.F, 0.F, static_cast<float>(getWidth()), static_cast<float>(getHeight()));
+	}
+
+	// Nothing below an opaque child that covers the whole window can be seen, neither the children
+	// before it nor what this Widget drew before drawing its children. Whether it covers the window
+	// depends on where this Widget is, like culling does.
+	std::list<Widget*>::const_iterator first = m_Children.begin();
+
+	for (auto it = m_Children.rbegin(); it != m_Children.rend(); ++it)
+	{
+		if ((*it)->occludesViewport() && (!m_clipsChildren || coversViewport()))
+		{
+			first = std::prev(it.base());
+
+			Renderer::discardRecording();
+			m_dependsOnViewport = true;
+			break;
+		}
+	}
+
+	for (auto it = first; it != m_Children.end(); ++it)
+	{
+		Widget* pChildWidget = *it;
+
 		if (pChildWidget->m_opacity > 0.F)
 		{
-			pChildWidget->draw();
+			// This only depends on where the child is inside of this Widget, so unlike the viewport
+			// it doesn't have to be checked again when this Widget moves
+			if (m_clipsChildren && pChildWidget->isOutsideParent())
+			{
+				continue;
+			}
+
+			if (pChildWidget->isOutsideViewport())
+			{
+				m_dependsOnViewport = true;
+				continue;
+			}
+
+			pChildWidget->render();
+
+			m_dependsOnViewport = m_dependsOnViewport || pChildWidget->m_dependsOnViewport;
 		}
 	}
+
+	if (m_clipsChildren)
+	{
+		Renderer::popClipRect();
+	}
+}
+
+/// <summary>
+/// Returns whether the bounds of the Widget contain the whole window.
+/// </summary>
+bool Widget::coversViewport(void) const noexcept
+{
+	const Point position = getAbsolutePosition();
+
+	return position.x <= 0 && position.y <= 0
+		&& position.x + static_cast<int32_t>(m_Size.width) >= WINDOW_WIDTH
+		&& position.y + static_cast<int32_t>(m_Size.height) >= WINDOW_HEIGHT;
+}
+
+/// <summary>
+/// Returns whether the Widget hides everything below it, which is the case if it is opaque,
+/// fully faded in and covers the whole window.
+/// </summary>
+bool Widget::occludesViewport(void) const noexcept
+{
+	return m_isOpaque && m_opacity >= 1.F && coversViewport();
+}
+
+/// <summary>
+/// Returns whether the Widget, including the CULL_MARGIN around it, is entirely outside of its parent.
+/// </summary>
+bool Widget::isOutsideParent(void) const noexcept
+{
+	return m_RelativePosition.x + static_cast<int32_t>(m_Size.width) + CULL_MARGIN < 0
+		|| m_RelativePosition.y + static_cast<int32_t>(m_Size.height) + CULL_MARGIN < 0
+		|| m_RelativePosition.x - CULL_MARGIN > static_cast<int32_t>(m_pParent->m_Size.width)
+		|| m_RelativePosition.y - CULL_MARGIN > static_cast<int32_t>(m_pParent->m_Size.height);
+}
+
+/// <summary>
+/// Returns whether the Widget, including the CULL_MARGIN around it, is entirely outside of the window.
+/// </summary>
+bool Widget::isOutsideViewport(void) const noexcept
+{
+	const Point position = getAbsolutePosition();
+
+	return position.x + static_cast<int32_t>(m_Size.width) + CULL_MARGIN < 0
+		|| position.y + static_cast<int32_t>(m_Size.height) + CULL_MARGIN < 0
+		|| position.x - CULL_MARGIN > WINDOW_WIDTH
+		|| position.y - CULL_MARGIN > WINDOW_HEIGHT;
 }
 
 void Widget::bringToTop(void)
@@ -463,6 +778,12 @@ void Widget::bringToTop(void)
 
 		m_pParent->m_Children.erase(it);
 		m_pParent->m_Children.emplace_back(pWidget);
+
+		m_zOrder = m_pParent->m_nextChildZOrder++;
+
+		++g_layoutGeneration;
+
+		m_pParent->invalidate();
 	}
 }
 
@@ -474,9 +795,17 @@ void Widget::bringToTop(void)
 /// <param name="b"></param>
 void Widget::setBackgroundColor(float r, float g, float b)
 {
+	// Some Widgets set their colors on every draw, which must not invalidate them again
+	if (m_bgBrush.fill_color[0] == r && m_bgBrush.fill_color[1] == g && m_bgBrush.fill_color[2] == b)
+	{
+		return;
+	}
+
 	m_bgBrush.fill_color[0] = r;
 	m_bgBrush.fill_color[1] = g;
 	m_bgBrush.fill_color[2] = b;
+
+	invalidate();
 }
 
 /// <summary>
@@ -487,20 +816,32 @@ void Widget::setBackgroundColor(float r, float g, float b)
 /// <param name="b"></param>
 void Widget::setOutlineColor(float r, float g, float b)
 {
+	if (m_bgBrush.outline_color[0] == r && m_bgBrush.outline_color[1] == g && m_bgBrush.outline_color[2] == b)
+	{
+		return;
+	}
+
 	m_bgBrush.outline_color[0] = r;
 	m_bgBrush.outline_color[1] = g;
 	m_bgBrush.outline_color[2] = b;
+
+	invalidate();
 }
 
 /// <summary>
-/// 
+/// Sets the opacity of the Widget. It applies to the whole Widget, children included,
+/// on top of the opacities of the brushes it draws with.
 /// </summary>
-/// <param name="f"></param>
+/// <param name="f">The opacity, from 0 (hidden) to 1</param>
 void Widget::setOpacity(float f)
 {
 	m_opacity = f;
-	m_bgBrush.fill_opacity = f;
-	m_bgBrush.outline_opacity = f;
+
+	// Like a move, this doesn't change the commands of the Widget, only how the parent draws them
+	if (m_pParent)
+	{
+		m_pParent->invalidate();
+	}
 }
 
 void Widget::show(void)
@@ -531,6 +872,13 @@ void Widget::addChild(Widget* pWidget)
 	assert(pWidget);
 
 	m_Children.emplace_back(pWidget);
+
+	pWidget->m_zOrder = m_nextChildZOrder++;
+	m_ChildGrid.insert(pWidget);
+
+	++g_layoutGeneration;
+
+	invalidate();
 }
 
 void Widget::setParent(Widget* newParent) noexcept
@@ -539,46 +887,88 @@ void Widget::setParent(Widget* newParent) noexcept
 
 	if (m_pParent)
 	{
+		m_pParent->m_ChildGrid.remove(this);
 		m_pParent->m_Children.remove(this);
+
+		++g_layoutGeneration;
+
+		m_pParent->invalidate();
 	}
 
+	m_pParent = newParent;
 	newParent->addChild(this);
+
+	// The position is relative to the parent, so the Widget has moved
+	invalidateTransform();
 }
 
+/// <summary>
+/// Starts sending TIMER messages with the given id to the Widget every delay milliseconds.
+/// Does nothing if a timer with the same id is already running.
+/// </summary>
 void Widget::addTimer(int timer_id, int delay)
 {
-	MessageGenerator::getInstance()->addTimer(this, timer_id, delay);
+	for (const RunningTimer& timer : m_Timers)
+	{
+		if (timer.id == timer_id)
+		{
+			return;
+		}
+	}
+
+	RunningTimer timer;
+	timer.id = timer_id;
+	timer.handle = MessageGenerator::getInstance()->addTimer(this, timer_id, delay);
+	m_Timers.push_back(timer);
 }
 
+/// <summary>
+/// Stops the timer with the given id. TIMER messages of the timer that are still
+/// in the event queue are dropped when they are dispatched, see Messenger::resolveTimer.
+/// </summary>
 void Widget::killTimer(int timer_id)
 {
-	MessageGenerator::getInstance()->killTimer(this, timer_id);
+	for (size_t i = 0; i < m_Timers.size(); ++i)
+	{
+		if (m_Timers[i].id == timer_id)
+		{
+			MessageGenerator::getInstance()->killTimer(m_Timers[i].handle);
+
+			m_Timers[i] = m_Timers.back();
+			m_Timers.pop_back();
+			return;
+		}
+	}
+}
 
-	// We want to remove any timer messages that may be left in the queue after killing the timer
-	std::queue<Message> newQueue;
+/// <summary>
+/// Called when a timer has elapsed count times since the Widget last heard from it, which is more than once
+/// if the frames couldn't keep up. By default onTimer is called once per time, until the timer is killed.
+/// Widgets whose timer handler can do the work of several ticks at once can override this instead.
+/// </summary>
+long Widget::onTimerElapsed(int timer_id, uint32_t count)
+{
+	long result = 0L;
 
-	// We remove each message from the front of the inbox and add it to the new queue
-	// if and only if the message isn't a timer message with the specified id
-	while (!m_Inbox.empty())
+	for (uint32_t i = 0; i < count && isTimerRunning(timer_id); ++i)
 	{
-		Message frontMsg = m_Inbox.front();
-		m_Inbox.pop();
+		result = onTimer(timer_id);
+	}
 
-		if (frontMsg.code == Message::Code::TIMER)
-		{
-			TimerMessageInfo* pInfo = reinterpret_cast<TimerMessageInfo*>(frontMsg.data);
+	return result;
+}
 
-			if (pInfo->timer_id == timer_id)
-			{
-				continue;
-			}
+bool Widget::isTimerRunning(int timer_id) const noexcept
+{
+	for (const RunningTimer& timer : m_Timers)
+	{
+		if (timer.id == timer_id)
+		{
+			return true;
 		}
-
-		newQueue.push(frontMsg);
 	}
 
-	// and finally we replace the inbox with the new queue
-	m_Inbox.swap(newQueue);
+	return false;
 }
 
 /// <summary>
@@ -587,7 +977,7 @@ void Widget::killTimer(int timer_id)
 /// <param name="message">Reference to the message that will be posted</param>
 void Widget::postMessage(const Message& message)
 {
-	m_Inbox.emplace(message);
+	g_eventQueue.push(this, message);
 }
 
 /// <summary>
@@ -595,30 +985,33 @@ void Widget::postMessage(const Message& message)
 /// </summary>
 /// <param name="message">Reference to a message struct</param>
 /// <returns>Depends on the message</returns>
-long Widget::processMessage(const Message& message)
+long Widget::processMessage(Message& message)
 {
+	// Handlers are where the state of a Widget changes, so anything it draws may be different afterwards
+	invalidate();
+
 	switch (message.code)
 	{
 	case Message::Code::LEFT_MOUSE_DOWN:
-		return onLeftMouseDown(*(Point*)message.data);
+		return onLeftMouseDown(message.point);
 
 	case Message::Code::LEFT_MOUSE_UP:
-		return onLeftMouseUp(*(Point*)message.data);
+		return onLeftMouseUp(message.point);
 
 	case Message::Code::MOUSE_ENTER:
-		return onMouseEnter((MouseMessageInfo*)message.data);
+		return onMouseEnter(&message.mouse);
 
 	case Message::Code::MOUSE_LEFT:
-		return onMouseLeft((MouseMessageInfo*)message.data);
+		return onMouseLeft(&message.mouse);
 
 	case Message::Code::MOVING_MOUSE:
-		return onDraggingMouse(*(Point*)message.data);
+		return onDraggingMouse(message.point);
 
 	case Message::Code::KEY_PRESSED:
-		return onKeyPressed((KeyMessageInfo*)message.data);
+		return onKeyPressed(&message.key);
 
 	case Message::Code::KEY_RELEASED:
-		return onKeyReleased((KeyMessageInfo*)message.data);
+		return onKeyReleased(&message.key);
 
 	case Message::Code::LOST_FOCUS:
 		return onLostFocus();
@@ -626,24 +1019,20 @@ long Widget::processMessage(const Message& message)
 	case Message::Code::GOT_FOCUS:
 		return onGotFocus();
 
-	case Message::Code::WINDOW_RESIZED: {
-		Size* pSize = (Size*)message.data;
-		return onResize(pSize->width, pSize->height);
-	}
+	case Message::Code::WINDOW_RESIZED:
+		return onResize(message.size.width, message.size.height);
 
 	case Message::Code::RIGHT_MOUSE_DOWN:
-		return onRightMouseDown(*(Point*)message.data);
+		return onRightMouseDown(message.point);
 
 	case Message::Code::RIGHT_MOUSE_UP:
-		return onRightMouseUp(*(Point*)message.data);
+		return onRightMouseUp(message.point);
 
-	case Message::Code::TIMER: {
-		TimerMessageInfo* pTimerInfo = reinterpret_cast<TimerMessageInfo*>(message.data);
-		return onTimer(pTimerInfo->timer_id);
-	}
+	case Message::Code::TIMER:
+		return onTimerElapsed(message.timer.timer_id, message.timer.count);
 
 	case Message::Code::CUSTOM:
-		return onCustom(reinterpret_cast<CustomMessageInfo*>(message.data));
+		return onCustom(message.custom);
 	}
 
 	return 1L;
@@ -3,17 +3,23 @@
 #include <sgg/graphics.h>
 
 #include <list>
-#include <queue>
+#include <vector>
 #include <cstdint>
 
 #include "types.h"
 #include "message.h"
 #include "message_generator.h"
+#include "spatial_grid.h"
+#include "draw_command.h"
 
 class Widget
 {
+	friend class SpatialGrid;
+	friend class Messenger;
+
 public:
 	Widget(const Size& size, const Point& position, Widget* pParent) noexcept;
+	virtual ~Widget(void);
 
 	Size getSize(void) const noexcept;
 	uint32_t getWidth(void) const noexcept;
@@ -54,8 +60,10 @@ public:
 
 	static Widget* getFocusWidget(void) noexcept;
 	static Widget* getCursorWidget(void) noexcept;
+	static void moveCustomPayloads(FrameArena& arena);
 
 	const std::list<Widget*>& getChildren(void) const noexcept;
+	Widget* getChildUnderPoint(const Point& point) const;
 	void removeChild(Widget* pWidget);
 	void removeFromParent(void);
 	Widget* getParent(void) const noexcept;
@@ -64,6 +72,9 @@ public:
 
 	void postMessage(const Message&);
 
+	void invalidate(void) noexcept;
+	void render(void);
+
 	virtual void update(float ms);
 	virtual void draw(void);
 	virtual void cleanup(void) {};
@@ -81,26 +92,117 @@ public:
 	virtual long onMouseEnter(MouseMessageInfo*) { return 0L; }
 	virtual long onDraggingMouse(Point point) { return 0L; }
 	virtual long onTimer(int timer_id) { return 0L; }
+	virtual long onTimerElapsed(int timer_id, uint32_t count);
 	virtual long onCustom(CustomMessageInfo*) { return 0L; }
 
+	// Called for input messages meant for a descendant, before (capture) and after (bubble) the descendant
+	// handles them. Points are in root coordinates. Returning true stops the message from going any further.
+	virtual bool onCaptureMessage(const Message& message, Widget* pTarget) { return false; }
+	virtual bool onBubbleMessage(const Message& message, Widget* pTarget) { return false; }
+
 protected:
 	void drawBackground(void) noexcept;
 	void drawChildren(void) noexcept;
 
 	bool hasChild(Widget* pWidget);
 
+	/// <summary>
+	/// Group opacity, inherited by everything the Widget and its children draw.
+	/// </summary>
 	float m_opacity = 1.0F;
-	graphics::Brush m_bgBrush;
+	Brush m_bgBrush;
+
+	/// <summary>
+	/// Whether the children are clipped to the bounds of the Widget, for containers whose content scrolls.
+	/// </summary>
+	bool m_clipsChildren = false;
+
+	/// <summary>
+	/// Set by Widgets that paint every pixel of their bounds with opaque brushes. While such a Widget is
+	/// fully faded in and covers the window, its parent skips drawing everything below it.
+	/// </summary>
+	bool m_isOpaque = false;
 
 private:
 	void addChild(Widget* pWidget);
-	long processMessage(const Message& message);
+	long processMessage(Message& message);
+	static void dispatchMessage(Widget* pReceiver, Message& message);
+
+	void invalidateTransform(void) noexcept;
+	bool coversViewport(void) const noexcept;
+	bool occludesViewport(void) const noexcept;
+	bool isOutsideParent(void) const noexcept;
+	bool isOutsideViewport(void) const noexcept;
+	void resolveTransform(void) const noexcept;
+	void updateParentGrid(void);
+	bool isTimerRunning(int timer_id) const noexcept;
 
 private:
 	Widget* m_pParent = nullptr;
 	std::list<Widget*> m_Children;
-	std::queue<Message> m_Inbox;
 
 	Size m_Size;
-	Point m_AbsolutePosition;
+
+	/// <summary>
+	/// Position of the top left corner of the Widget relative to the top left corner of the parent.
+	/// </summary>
+	Point m_RelativePosition;
+
+	/// <summary>
+	/// Cached position of the top left corner of the Widget relative to the root Widget.
+	/// Only valid if m_isTransformDirty is false.
+	/// </summary>
+	mutable Point m_AbsolutePosition;
+
+	/// <summary>
+	/// Set when the Widget or any of its ancestors has moved since m_AbsolutePosition was calculated.
+	/// If a Widget is dirty then all of its descendants are dirty as well.
+	/// </summary>
+	mutable bool m_isTransformDirty = true;
+
+	/// <summary>
+	/// Spatial index of the children, used for hit-testing.
+	/// </summary>
+	SpatialGrid m_ChildGrid;
+
+	/// <summary>
+	/// The cells of the parent's grid that this Widget has been inserted into.
+	/// </summary>
+	GridCellRange m_GridCellRange;
+
+	/// <summary>
+	/// Position of the Widget in the parent's drawing order. Widgets with a higher value are on top.
+	/// </summary>
+	uint32_t m_zOrder = 0;
+	uint32_t m_nextChildZOrder = 0;
+
+	/// <summary>
+	/// The timers of the Widget that are running, so that they can be killed by id.
+	/// A Widget only ever has a handful of timers, so a vector is good enough.
+	/// </summary>
+	struct RunningTimer
+	{
+		int id;
+		TimerHandle handle;
+	};
+
+	std::vector<RunningTimer> m_Timers;
+
+	/// <summary>
+	/// Everything the last call to draw() drew, children included, relative to the top left corner of the Widget.
+	/// Replayed by render() instead of calling draw() again, until the Widget is invalidated.
+	/// </summary>
+	DrawCommandList m_DrawCommands;
+
+	/// <summary>
+	/// Set when something the Widget draws has changed since m_DrawCommands was recorded.
+	/// </summary>
+	bool m_isDrawCacheDirty = true;
+
+	/// <summary>
+	/// Set when a descendant was culled while m_DrawCommands was recorded. The commands are then
+	/// only valid while the Widget stays at m_recordedPosition, the absolute position they were recorded at.
+	/// </summary>
+	bool m_dependsOnViewport = false;
+	Point m_recordedPosition = Point(0, 0);
 };
\ No newline at end of file